@@ -0,0 +1,242 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "admission_controller.hpp"
+#include "condor_job_adaptor.hpp"
+#include "log_processor.hpp"
+#include "pool_data.hpp"
+#include "shared_job_data.hpp"
+
+#include <saga/saga-defs.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    namespace {
+
+        int get_priority(::condor::job::description const & desc)
+        {
+            typedef ::condor::job::description::attributes_type
+                attributes_type;
+
+            attributes_type const & attributes = desc.get_attributes();
+            attributes_type::const_iterator it = attributes.find("priority");
+            if (attributes.end() == it)
+                return 0;
+
+            try
+            {
+                return boost::lexical_cast<int>(it->second);
+            }
+            catch (boost::bad_lexical_cast const &)
+            {
+                return 0;
+            }
+        }
+
+    } // namespace
+
+    admission_controller::admission_controller(job_adaptor const & adaptor,
+            pool & p)
+        : adaptor_(adaptor)
+        , pool_(p)
+        , config_(adaptor.get_flow_control_config())
+        , queue_(config_.max_idle)
+        , stop_(false)
+        , thread_(boost::bind(&admission_controller::dispatch, this))
+    {
+    }
+
+    admission_controller::~admission_controller()
+    {
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+            stop_ = true;
+        }
+        room_.notify_all();
+
+        thread_.join();
+    }
+
+    bool admission_controller::admit(::condor::job::description const & desc,
+            boost::shared_ptr<shared_job_data> const & job)
+    {
+        std::size_t const count = desc.get_process_count();
+
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+            if (queue_.admit(count))
+                return true;
+        }
+
+        {
+            shared_job_data::scoped_lock lock(job->state_change_mtx);
+            job->queued = true;
+        }
+
+        entry e;
+        e.desc = desc;
+        e.job = job;
+        e.count = count;
+
+        boost::mutex::scoped_lock lock(mtx_);
+        queue_.push(e, get_priority(desc));
+
+        // In case the pool drained in the meantime.
+        room_.notify_all();
+
+        return false;
+    }
+
+    bool admission_controller::cancel(
+            boost::shared_ptr<shared_job_data> const & job)
+    {
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+
+            admission_queue::removal r;
+            while (admission_queue::dispatching == (r = queue_.remove(job)))
+                dispatched_.wait(lock);
+
+            if (admission_queue::not_queued == r)
+                return false;
+        }
+
+        shared_job_data::scoped_lock lock(job->state_change_mtx);
+        job->queued = false;
+        job->state = saga::job::Canceled;
+        log_processor::notify(*job, -1);
+
+        return true;
+    }
+
+    void admission_controller::idle_changed(long delta)
+    {
+        if (!delta)
+            return;
+
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+            queue_.idle_changed(delta);
+        }
+
+        if (delta < 0)
+            room_.notify_all();
+    }
+
+    std::size_t admission_controller::get_idle_count() const
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+        return queue_.get_idle_count();
+    }
+
+    std::size_t admission_controller::get_queue_size() const
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+        return queue_.size();
+    }
+
+    void admission_controller::dispatch()
+    {
+        for (;;)
+        {
+            entry e;
+            {
+                boost::mutex::scoped_lock lock(mtx_);
+                while (!stop_ && !queue_.pop(e))
+                    room_.wait(lock);
+
+                if (stop_)
+                    return;
+            }
+
+            submit(e);
+
+            {
+                boost::mutex::scoped_lock lock(mtx_);
+                queue_.done();
+            }
+            dispatched_.notify_all();
+        }
+    }
+
+    void admission_controller::submit(entry const & e)
+    {
+        using namespace saga::job::attributes;
+
+        shared_job_data & job = *e.job;
+        std::string error;
+
+        try
+        {
+            std::string cluster_id, output;
+            std::size_t processes = 0;
+
+            // Returns with the registry locked, events are held back.
+            synchronized<job_registry>::lock lck = adaptor_.submit(pool_,
+                e.desc, cluster_id, output, &processes);
+
+            // As reported by condor_submit, if it did.
+            if (!processes)
+                processes = e.count;
+            else
+                idle_changed(long(processes) - long(e.count));
+
+            shared_job_data::scoped_lock lock(job.state_change_mtx);
+
+            job.queued = false;
+            job.flow_controlled = true;
+            job.idle_procs = processes;
+
+            job.state = saga::job::Running;
+            if (processes > 1)
+                job.procs.resize(processes);
+
+            if (!cluster_id.empty())
+                job.cluster_id = cluster_id;
+            else
+            {
+                std::string msg = "Failed to determine Cluster ID from the "
+                    "output of condor_submit (see below). Won't be able to "
+                    "perform further operations on the job.\n" + output;
+                SAGA_LOG_WARN(msg.c_str())
+
+                job.cluster_id = "Unknown";
+            }
+
+            job.full_job_id = "[" + pool_.get_url() + "]-["
+                + job.cluster_id + "]";
+            job.attributes[jobid] = job.full_job_id;
+
+            if (!cluster_id.empty())
+                lck->register_job(e.job);
+            log_processor::notify(job, -1);
+            return;
+        }
+        catch (saga::exception const & ex)
+        {
+            error = ex.what();
+        }
+        catch (std::exception const & ex)
+        {
+            error = std::string("Problem launching condor job: "
+                "(std::exception caught: ") + ex.what() + ")";
+        }
+
+        // There's no one to throw at, job failed.
+        SAGA_LOG_ERROR(("Condor adaptor (admission control): Failed to "
+            "submit queued job. " + error).c_str());
+
+        idle_changed(-long(e.count));
+
+        shared_job_data::scoped_lock lock(job.state_change_mtx);
+        job.queued = false;
+        job.state = saga::job::Failed;
+        log_processor::notify(job, -1);
+    }
+
+}}} // namespace saga::adaptors::condor
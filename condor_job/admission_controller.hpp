@@ -0,0 +1,218 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_ADMISSION_CONTROLLER_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_ADMISSION_CONTROLLER_HPP
+
+#include "description.hpp"
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+
+#include <map>
+#include <string>
+#include <utility>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    class job_adaptor;
+    struct pool;
+    struct shared_job_data;
+
+    //  Jobs waiting for admission, and the number of idle processes in the
+    //  pool, for admission_controller. Not synchronized.
+    //
+    //  The entry last popped is being dispatched until done() is called,
+    //  and can't be removed from the queue in the meantime.
+    struct admission_queue
+    {
+        struct entry
+        {
+            ::condor::job::description desc;
+            boost::shared_ptr<shared_job_data> job;
+            std::size_t count;
+        };
+
+        enum removal
+        {
+            removed,
+            dispatching,
+            not_queued
+        };
+
+        explicit admission_queue(std::size_t max_idle)
+            : max_idle_(max_idle)
+            , sequence_(0)
+            , idle_(0)
+        {
+        }
+
+        //  Counts count processes as idle and returns true if they can be
+        //  submitted right away, ahead of any queued jobs.
+        bool admit(std::size_t count)
+        {
+            if (!queue_.empty() || !has_room(count))
+                return false;
+
+            idle_ += count;
+            return true;
+        }
+
+        // Condor runs jobs with higher priority values first.
+        void push(entry const & e, int priority)
+        {
+            queue_.insert(std::make_pair(
+                entry_key(-priority, sequence_++), e));
+        }
+
+        //  Pops the next entry into e, if there's room for it, counting its
+        //  processes as idle. The entry is then being dispatched.
+        bool pop(entry & e)
+        {
+            if (queue_.empty() || !has_room((*queue_.begin()).second.count))
+                return false;
+
+            e = (*queue_.begin()).second;
+            queue_.erase(queue_.begin());
+
+            idle_ += e.count;
+            dispatching_ = e.job;
+            return true;
+        }
+
+        // The entry last popped is no longer being dispatched.
+        void done()
+        {
+            dispatching_.reset();
+        }
+
+        removal remove(boost::shared_ptr<shared_job_data> const & job)
+        {
+            if (job == dispatching_)
+                return dispatching;
+
+            entry_queue::iterator it = queue_.begin(), end = queue_.end();
+            while (it != end && (*it).second.job != job)
+                ++it;
+
+            if (end == it)
+                return not_queued;
+
+            queue_.erase(it);
+            return removed;
+        }
+
+        void idle_changed(long delta)
+        {
+            if (delta < 0 && std::size_t(-delta) > idle_)
+                idle_ = 0;
+            else
+                idle_ += delta;
+        }
+
+        std::size_t get_idle_count() const
+        {
+            return idle_;
+        }
+
+        std::size_t size() const
+        {
+            return queue_.size();
+        }
+
+    private:
+        // Highest priority first, then first come, first served.
+        typedef std::pair<int, unsigned long> entry_key;
+        typedef std::map<entry_key, entry> entry_queue;
+
+        //  A single cluster larger than the limit is only admitted when no
+        //  other controlled jobs are idle.
+        bool has_room(std::size_t count) const
+        {
+            return !idle_ || idle_ + count <= max_idle_;
+        }
+
+        std::size_t const max_idle_;
+
+        entry_queue queue_;
+        unsigned long sequence_;
+        std::size_t idle_;
+
+        boost::shared_ptr<shared_job_data> dispatching_;
+    };
+
+    //  Caps the number of idle jobs (processes, really) the adaptor keeps in
+    //  the schedd, for each pool.
+    //
+    //  Jobs run while the pool is at its limit are kept in a local queue,
+    //  ordered by their Condor priority and, within the same priority, in
+    //  the order they were run. While queued, jobs are New and have no job
+    //  ID. A dispatcher thread submits them as the log processor reports
+    //  jobs leaving the idle state (i.e., starting, being held or
+    //  finishing).
+    //
+    //  A single cluster larger than the limit is only admitted when no other
+    //  controlled jobs are idle.
+    struct admission_controller
+    {
+        struct config
+        {
+            config()
+                : max_idle(0)
+            {
+            }
+
+            // Maximum number of idle processes, 0 for no limit.
+            std::size_t max_idle;
+        };
+
+        admission_controller(job_adaptor const & adaptor, pool & p);
+
+        // Stops the dispatcher. Jobs still queued are not submitted.
+        ~admission_controller();
+
+        //  Admits job for submission of desc. Returns true if the job can
+        //  be submitted right away, in which case its processes are already
+        //  counted as idle. Otherwise, the job is queued and later submitted
+        //  by the dispatcher.
+        bool admit(::condor::job::description const & desc,
+            boost::shared_ptr<shared_job_data> const & job);
+
+        //  Removes job from the queue, marking it Canceled. Returns false if
+        //  the job was no longer queued. A job being submitted by the
+        //  dispatcher is waited for, and then no longer queued.
+        bool cancel(boost::shared_ptr<shared_job_data> const & job);
+
+        //  Updates the number of idle processes. Called by the log processor
+        //  as controlled jobs change state, and on failed submissions of
+        //  admitted jobs.
+        void idle_changed(long delta);
+
+        std::size_t get_idle_count() const;
+        std::size_t get_queue_size() const;
+
+    private:
+        typedef admission_queue::entry entry;
+
+        void dispatch();
+        void submit(entry const & e);
+
+        job_adaptor const & adaptor_;
+        pool & pool_;
+        config const config_;
+
+        mutable boost::mutex mtx_;
+        boost::condition room_;
+        boost::condition dispatched_;
+        admission_queue queue_;
+        bool stop_;
+
+        boost::thread thread_;
+    };
+
+}}} // namespace saga::adaptors::condor
+
+#endif // include guard
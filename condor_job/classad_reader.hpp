@@ -0,0 +1,107 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_CLASSAD_READER_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_CLASSAD_READER_HPP
+
+#include <boost/function.hpp>
+
+#include <algorithm>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    //  Splits a stream of XML ClassAds, such as the output of condor_q -xml,
+    //  into its records ("<c>...</c>"), as it is read. The stream is read in
+    //  chunks of a fixed size, and only the current chunk and the record
+    //  being read are kept in memory, however long the stream.
+    //
+    //  As in the classad parser, nested ClassAds are not supported.
+    struct classad_reader
+    {
+        // Called with each record, "<c>" and "</c>" included.
+        typedef boost::function<void(std::string const &)> callback;
+
+        explicit classad_reader(std::size_t chunk_size = 64 * 1024)
+            : chunk_(chunk_size ? chunk_size : 1)
+        {
+        }
+
+        //  Reads is to the end, handing records to f in order. Returns the
+        //  number of records read.
+        std::size_t read(std::istream & is, callback const & f)
+        {
+            static std::string const open_tag = "<c>";
+            static std::string const close_tag = "</c>";
+
+            std::size_t records = 0;
+
+            // Unprocessed data, starting at a record, or at data that may
+            // start one.
+            std::string pending;
+            bool in_record = false;
+
+            // Where to resume the search for a closing tag.
+            std::string::size_type scanned = 0;
+
+            while (is)
+            {
+                is.read(&chunk_[0], chunk_.size());
+                pending.append(&chunk_[0], is.gcount());
+
+                std::string::size_type begin = 0;
+                for (;;)
+                {
+                    if (!in_record)
+                    {
+                        std::string::size_type const start
+                            = pending.find(open_tag, begin);
+                        if (std::string::npos == start)
+                        {
+                            // Keep what could be the start of a tag.
+                            if (pending.size() - begin >= open_tag.size())
+                                begin = pending.size() - open_tag.size() + 1;
+                            break;
+                        }
+
+                        begin = start;
+                        scanned = start + open_tag.size();
+                        in_record = true;
+                    }
+
+                    std::string::size_type const end
+                        = pending.find(close_tag, scanned);
+                    if (std::string::npos == end)
+                    {
+                        if (pending.size() >= close_tag.size())
+                            scanned = (std::max)(scanned,
+                                pending.size() - close_tag.size() + 1);
+                        break;
+                    }
+
+                    std::string::size_type const stop = end + close_tag.size();
+                    f(pending.substr(begin, stop - begin));
+                    ++records;
+
+                    begin = stop;
+                    in_record = false;
+                }
+
+                pending.erase(0, begin);
+                scanned -= (std::min)(scanned, begin);
+            }
+
+            return records;
+        }
+
+    private:
+        std::vector<char> chunk_;
+    };
+
+}}} // namespace saga::adaptors::condor
+
+#endif // include guard
@@ -0,0 +1,53 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_CLOCK_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_CLOCK_HPP
+
+#include <boost/thread/xtime.hpp>
+
+namespace saga { namespace adaptors { namespace condor { namespace detail {
+
+    // Current time, in seconds since the epoch.
+    inline double now()
+    {
+        boost::xtime t;
+        boost::xtime_get(&t, boost::TIME_UTC);
+        return t.sec + t.nsec / 1e9;
+    }
+
+    //  Absolute time, in seconds since the epoch as returned by now(), for
+    //  timed waits and sleeps.
+    inline boost::xtime to_xtime(double time)
+    {
+        boost::xtime t;
+        t.sec = static_cast<boost::xtime::xtime_sec_t>(time);
+        t.nsec = static_cast<boost::xtime::xtime_nsec_t>(
+            (time - t.sec) * 1e9);
+        return t;
+    }
+
+    // Deadline delay seconds from now, to sub-second resolution.
+    inline boost::xtime make_deadline(double delay)
+    {
+        boost::xtime t;
+        boost::xtime_get(&t, boost::TIME_UTC);
+
+        boost::xtime::xtime_sec_t sec
+            = static_cast<boost::xtime::xtime_sec_t>(delay);
+        t.sec += sec;
+        t.nsec += static_cast<boost::xtime::xtime_nsec_t>(
+            (delay - sec) * 1e9);
+        if (t.nsec >= 1000000000)
+        {
+            t.sec += 1;
+            t.nsec -= 1000000000;
+        }
+        return t;
+    }
+
+}}}} // namespace saga::adaptors::condor::detail
+
+#endif // include guard
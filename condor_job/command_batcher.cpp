@@ -0,0 +1,156 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "command_batcher.hpp"
+#include "clock.hpp"
+#include "condor_job_adaptor.hpp"
+
+#include <saga/saga-defs.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    command_batcher::command_batcher(job_adaptor const & adaptor)
+        : adaptor_(adaptor)
+        , config_(adaptor.get_batching_config())
+        , pending_count_(0)
+        , stop_(false)
+        , thread_(boost::bind(&command_batcher::flush_loop, this))
+    {
+    }
+
+    command_batcher::~command_batcher()
+    {
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+            stop_ = true;
+        }
+        pending_changed_.notify_all();
+
+        thread_.join();
+
+        request_map::iterator end = pending_.end();
+        for (request_map::iterator it = pending_.begin(); it != end; ++it)
+            for (std::size_t i = 0; i < (*it).second.size(); ++i)
+                (*it).second[i].done->set_error("Condor adaptor is shutting "
+                    "down, " + (*it).first + " was not run.",
+                    saga::NoSuccess);
+    }
+
+    boost::shared_ptr<completion> command_batcher::post(
+            std::string const & command, std::string const & job_id)
+    {
+        request r;
+        r.job_id = job_id;
+        r.done.reset(new completion);
+
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+            pending_[command].push_back(r);
+            ++pending_count_;
+        }
+        pending_changed_.notify_all();
+
+        return r.done;
+    }
+
+    void command_batcher::flush_loop()
+    {
+        for (;;)
+        {
+            request_map batch;
+            {
+                boost::mutex::scoped_lock lock(mtx_);
+
+                while (!stop_ && pending_.empty())
+                    pending_changed_.wait(lock);
+
+                if (stop_)
+                    return;
+
+                // Give other requests a chance to join in.
+                boost::xtime const deadline
+                    = detail::make_deadline(config_.max_delay);
+                while (!stop_ && pending_count_ < config_.max_jobs)
+                    if (!pending_changed_.timed_wait(lock, deadline))
+                        break;
+
+                if (stop_)
+                    return;
+
+                batch.swap(pending_);
+                pending_count_ = 0;
+            }
+
+            request_map::const_iterator end = batch.end();
+            for (request_map::const_iterator it = batch.begin(); it != end;
+                    ++it)
+            {
+                request_list const & requests = (*it).second;
+                for (std::size_t i = 0; i < requests.size();
+                        i += config_.max_jobs)
+                    run_command((*it).first, request_list(
+                        requests.begin() + i,
+                        requests.begin() + (std::min)(requests.size(),
+                            i + config_.max_jobs)));
+            }
+        }
+    }
+
+    void command_batcher::run_command(std::string const & command,
+            request_list const & requests) const
+    {
+        std::set<std::string> job_ids;
+        for (std::size_t i = 0; i < requests.size(); ++i)
+            job_ids.insert(requests[i].job_id);
+
+        std::vector<std::string> args(job_ids.begin(), job_ids.end());
+
+        std::string output;
+        std::string error;
+        bool succeeded = false;
+
+        try
+        {
+            command_result result = adaptor_.run_condor_command(command,
+                args);
+
+            output = result.output;
+            succeeded = result.succeeded();
+        }
+        catch (std::exception const & e)
+        {
+            error = std::string("Problem invoking " + command
+                + ": (std::exception caught: ") + e.what() + ")";
+        }
+
+        SAGA_LOG_DEBUG(("Condor adaptor: " + command + " ran for "
+            + boost::lexical_cast<std::string>(args.size()) + " jobs.")
+            .c_str());
+
+        std::set<std::string> confirmed;
+        if (!succeeded && error.empty())
+            confirmed = get_succeeded(output);
+
+        for (std::size_t i = 0; i < requests.size(); ++i)
+        {
+            request const & r = requests[i];
+
+            if (succeeded || confirmed.count(r.job_id))
+                r.done->set_done();
+            else if (!error.empty())
+                r.done->set_error(error, saga::NoSuccess);
+            else
+                r.done->set_error("Failed to run " + command + " on condor "
+                    "job [" + r.job_id + "]. Output from " + command
+                    + " follows:\n" + output, saga::NoSuccess);
+        }
+    }
+
+}}} // namespace saga::adaptors::condor
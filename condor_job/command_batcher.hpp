@@ -0,0 +1,115 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_COMMAND_BATCHER_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_COMMAND_BATCHER_HPP
+
+#include "completion.hpp"
+
+#include <boost/regex.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    class job_adaptor;
+
+    //  Coalesces job management commands that take a list of job IDs
+    //  (condor_rm, condor_hold, condor_release) into one invocation per
+    //  command for many jobs.
+    //
+    //  Requests are collected for up to max_delay seconds after the first
+    //  one comes in, or until max_jobs are pending, and then flushed by a
+    //  background thread. Callers get a completion that is done once the
+    //  command has run, and failed if Condor reported an error for their
+    //  job. Confirmation that jobs actually changed state comes from the job
+    //  log.
+    struct command_batcher
+    {
+        struct config
+        {
+            config()
+                : max_delay(.1)
+                , max_jobs(1000)
+            {
+            }
+
+            // Seconds
+            double max_delay;
+
+            // Maximum number of job IDs passed to a single command.
+            std::size_t max_jobs;
+        };
+
+        explicit command_batcher(job_adaptor const & adaptor);
+
+        // Pending requests are failed.
+        ~command_batcher();
+
+        //  Queues job_id ("Cluster" or "Cluster.Proc") for command.
+        boost::shared_ptr<completion> post(std::string const & command,
+            std::string const & job_id);
+
+        //  Job IDs a command reported success for, from its output. Used
+        //  when the command fails for some of the jobs.
+        static std::set<std::string> get_succeeded(std::string const & output)
+        {
+            // E.g., "Cluster 12 has been marked for removal.", "Job 12.3
+            // held." or "All jobs in cluster 12 have been released".
+            static boost::regex const re(
+                "^(?:(?:Job|Cluster) (\\d+(?:\\.\\d+)?) (?:has been )?"
+                "|All jobs in cluster (\\d+) have been )"
+                "(?:marked for removal|held|released)");
+
+            std::set<std::string> job_ids;
+
+            std::istringstream is(output);
+            for (std::string line; std::getline(is, line); )
+            {
+                boost::smatch match;
+                if (boost::regex_search(line, match, re))
+                    job_ids.insert(match[1].matched
+                        ? match.str(1) : match.str(2));
+            }
+
+            return job_ids;
+        }
+
+    private:
+        struct request
+        {
+            std::string job_id;
+            boost::shared_ptr<completion> done;
+        };
+
+        typedef std::vector<request> request_list;
+        typedef std::map<std::string, request_list> request_map;
+
+        void flush_loop();
+        void run_command(std::string const & command,
+            request_list const & requests) const;
+
+        job_adaptor const & adaptor_;
+        config const config_;
+
+        boost::mutex mtx_;
+        boost::condition pending_changed_;
+        request_map pending_;
+        std::size_t pending_count_;
+        bool stop_;
+
+        boost::thread thread_;
+    };
+
+}}} // namespace saga::adaptors::condor
+
+#endif // include guard
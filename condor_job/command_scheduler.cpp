@@ -0,0 +1,301 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "command_scheduler.hpp"
+#include "clock.hpp"
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    struct command_scheduler::flight
+    {
+        flight()
+            : done(false)
+        {
+        }
+
+        bool done;
+        command_result result;
+        std::string error;
+        boost::condition finished;
+    };
+
+    struct command_scheduler::watch
+    {
+        watch(child_process const & c, double d)
+            : child(c)
+            , deadline(d)
+            , expired(false)
+        {
+        }
+
+        child_process child;
+        double deadline;
+        bool expired;
+    };
+
+    // Holds one of the slots available to a command.
+    struct command_scheduler::slot
+    {
+        slot(command_scheduler & s, std::string const & command)
+            : scheduler_(s)
+            , command_(command)
+        {
+            scheduler_.acquire(command_);
+        }
+
+        ~slot()
+        {
+            scheduler_.release(command_);
+        }
+
+    private:
+        command_scheduler & scheduler_;
+        std::string const & command_;
+    };
+
+    command_scheduler::command_scheduler(process_launcher const & launcher,
+            config const & c)
+        : launcher_(launcher)
+        , config_(c)
+        , stop_(false)
+    {
+    }
+
+    command_scheduler::~command_scheduler()
+    {
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+            stop_ = true;
+        }
+        watches_changed_.notify_all();
+
+        if (watchdog_)
+            watchdog_->join();
+    }
+
+    command_result command_scheduler::run(std::string const & command,
+            std::vector<std::string> const & arguments,
+            producer const & produce)
+    {
+        return execute(command, arguments, produce, 0);
+    }
+
+    command_result command_scheduler::stream(std::string const & command,
+            std::vector<std::string> const & arguments,
+            consumer const & consume)
+    {
+        return execute(command, arguments, producer(), &consume);
+    }
+
+    command_result command_scheduler::execute(std::string const & command,
+            std::vector<std::string> const & arguments,
+            producer const & produce, consumer const * consume)
+    {
+        slot s(*this, command);
+
+        child_process c = launcher_.start(command, arguments,
+            produce.empty()
+                ? process_launcher::close_stream
+                : process_launcher::redirect_stream,
+            process_launcher::redirect_stream,
+            process_launcher::close_stream);
+
+        shared_watch w = add_watch(c);
+
+        command_result result;
+        try
+        {
+            if (!produce.empty())
+            {
+                produce(c.get_stdin());
+                c.get_stdin() << std::flush;
+
+                // The command exited, or closed its input, early.
+                result.input_complete = c.get_stdin().good();
+                c.close_stdin();
+            }
+
+            std::istream & out = c.get_stdout();
+            if (consume)
+            {
+                (*consume)(out);
+
+                // Whatever consume left behind.
+                out.ignore(std::numeric_limits<std::streamsize>::max());
+            }
+            else
+                result.output.assign(std::istreambuf_iterator<char>(out),
+                    std::istreambuf_iterator<char>());
+
+            result.status = c.wait();
+        }
+        catch (...)
+        {
+            c.kill();
+            c.wait();
+            remove_watch(w);
+            throw;
+        }
+
+        if (remove_watch(w))
+            throw std::runtime_error(command + " didn't finish within "
+                + boost::lexical_cast<std::string>(config_.timeout)
+                + " seconds, and was killed.");
+
+        return result;
+    }
+
+    command_result command_scheduler::query(std::string const & command,
+            std::vector<std::string> const & arguments)
+    {
+        std::string key = command;
+        for (std::size_t i = 0; i < arguments.size(); ++i)
+            key += '\0' + arguments[i];
+
+        shared_flight f;
+        bool leader = false;
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+
+            shared_flight & in_flight = flights_[key];
+            if (!in_flight)
+            {
+                in_flight.reset(new flight());
+                leader = true;
+            }
+            f = in_flight;
+
+            if (!leader)
+            {
+                while (!f->done)
+                    f->finished.wait(lock);
+
+                if (!f->error.empty())
+                    throw std::runtime_error(f->error);
+                return f->result;
+            }
+        }
+
+        command_result result;
+        std::string error;
+        try
+        {
+            result = run(command, arguments);
+        }
+        catch (std::exception const & e)
+        {
+            error = e.what();
+            if (error.empty())
+                error = "Failed to run " + command + ".";
+        }
+
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+
+            f->result = result;
+            f->error = error;
+            f->done = true;
+            flights_.erase(key);
+        }
+        f->finished.notify_all();
+
+        if (!error.empty())
+            throw std::runtime_error(error);
+        return result;
+    }
+
+    void command_scheduler::acquire(std::string const & command)
+    {
+        std::size_t const limit = config_.get_limit(command);
+
+        boost::mutex::scoped_lock lock(mtx_);
+
+        std::size_t & running = running_[command];
+        while (limit && running >= limit)
+            slot_freed_.wait(lock);
+        ++running;
+    }
+
+    void command_scheduler::release(std::string const & command)
+    {
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+            --running_[command];
+        }
+        slot_freed_.notify_all();
+    }
+
+    command_scheduler::shared_watch command_scheduler::add_watch(
+            child_process const & c)
+    {
+        if (!(config_.timeout > 0.))
+            return shared_watch();
+
+        shared_watch w(new watch(c, detail::now() + config_.timeout));
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+
+            watches_.push_back(w);
+            if (!watchdog_)
+                watchdog_.reset(new boost::thread(
+                    boost::bind(&command_scheduler::watchdog, this)));
+        }
+        watches_changed_.notify_all();
+
+        return w;
+    }
+
+    bool command_scheduler::remove_watch(shared_watch const & w)
+    {
+        if (!w)
+            return false;
+
+        boost::mutex::scoped_lock lock(mtx_);
+
+        watches_.remove(w);
+        return w->expired;
+    }
+
+    void command_scheduler::watchdog()
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+
+        while (!stop_)
+        {
+            double const t = detail::now();
+            double next = -1.;
+
+            std::list<shared_watch>::iterator end = watches_.end();
+            for (std::list<shared_watch>::iterator it = watches_.begin();
+                    it != end; ++it)
+            {
+                watch & w = **it;
+                if (w.expired)
+                    continue;
+
+                if (w.deadline <= t)
+                {
+                    w.expired = true;
+                    w.child.kill();
+                }
+                else if (next < 0. || w.deadline < next)
+                    next = w.deadline;
+            }
+
+            if (next < 0.)
+                watches_changed_.wait(lock);
+            else
+                watches_changed_.timed_wait(lock, detail::to_xtime(next));
+        }
+    }
+
+}}} // namespace saga::adaptors::condor
@@ -0,0 +1,162 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_COMMAND_SCHEDULER_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_COMMAND_SCHEDULER_HPP
+
+#include "process.hpp"
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    struct command_result
+    {
+        command_result()
+            : input_complete(true)
+        {
+        }
+
+        process_status status;
+
+        // stdout and stderr, merged.
+        std::string output;
+
+        // False if the command exited before reading all of its input.
+        bool input_complete;
+
+        bool succeeded() const
+        {
+            return input_complete
+                && status.exited() && 0 == status.exit_status();
+        }
+    };
+
+    //  Runs Condor commands on behalf of the adaptor, so a burst of callers
+    //  (e.g., many jobs reconnecting at once) doesn't turn into a burst of
+    //  processes hitting the schedd.
+    //
+    //   - The number of concurrent invocations of each command is capped.
+    //     Callers over the cap wait their turn.
+    //   - Identical queries (see query()) already in flight are not run
+    //     again, callers share the result of the running one.
+    //   - Commands running past their deadline are killed, and reported as
+    //     errors to callers.
+    class command_scheduler
+        : boost::noncopyable
+    {
+    public:
+        struct config
+        {
+            config()
+                : max_concurrent(8)
+                , timeout(300.)
+            {
+            }
+
+            // Maximum concurrent invocations of each command, unless
+            // overridden in limits. 0 for no limit.
+            std::size_t max_concurrent;
+            std::map<std::string, std::size_t> limits;
+
+            // Seconds a command may run before it is killed. 0 for no limit.
+            double timeout;
+
+            std::size_t get_limit(std::string const & command) const
+            {
+                std::map<std::string, std::size_t>::const_iterator it
+                    = limits.find(command);
+                return limits.end() != it ? (*it).second : max_concurrent;
+            }
+        };
+
+        // Reads the output of a command, as it runs.
+        typedef boost::function<void(std::istream &)> consumer;
+
+        // Writes the input of a command, as it starts.
+        typedef boost::function<void(std::ostream &)> producer;
+
+        command_scheduler(process_launcher const & launcher,
+            config const & c = config());
+
+        ~command_scheduler();
+
+        //  Runs command with arguments, with its input written by produce,
+        //  if given. Input the command doesn't read fails the command.
+        //  Throws std::runtime_error if the command can't be started or
+        //  runs past its deadline. Exceptions thrown by produce kill the
+        //  command, and are passed on.
+        command_result run(std::string const & command,
+            std::vector<std::string> const & arguments,
+            producer const & produce = producer());
+
+        //  As run, with output handed to consume as it is produced, instead
+        //  of being collected in the result. Exceptions thrown by consume
+        //  kill the command, and are passed on.
+        command_result stream(std::string const & command,
+            std::vector<std::string> const & arguments,
+            consumer const & consume);
+
+        //  As run, for commands with no side effects (condor_q,
+        //  condor_history). Calls identical to one in flight wait for, and
+        //  return, its result.
+        command_result query(std::string const & command,
+            std::vector<std::string> const & arguments);
+
+        config const & get_config() const
+        {
+            return config_;
+        }
+
+    private:
+        struct flight;
+        struct slot;
+        struct watch;
+
+        typedef boost::shared_ptr<flight> shared_flight;
+        typedef boost::shared_ptr<watch> shared_watch;
+
+        command_result execute(std::string const & command,
+            std::vector<std::string> const & arguments,
+            producer const & produce, consumer const * consume);
+
+        void acquire(std::string const & command);
+        void release(std::string const & command);
+
+        shared_watch add_watch(child_process const & c);
+        bool remove_watch(shared_watch const & w);
+
+        void watchdog();
+
+        process_launcher const & launcher_;
+        config const config_;
+
+        boost::mutex mtx_;
+
+        // Running invocations, per command.
+        std::map<std::string, std::size_t> running_;
+        boost::condition slot_freed_;
+
+        std::map<std::string, shared_flight> flights_;
+
+        std::list<shared_watch> watches_;
+        boost::condition watches_changed_;
+        bool stop_;
+        boost::scoped_ptr<boost::thread> watchdog_;
+    };
+
+}}} // namespace saga::adaptors::condor
+
+#endif // include guard
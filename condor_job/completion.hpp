@@ -0,0 +1,106 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_COMPLETION_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_COMPLETION_HPP
+
+#include "clock.hpp"
+
+#include <saga/saga/error.hpp>
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+
+#include <string>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    //  Outcome of an operation completed elsewhere, e.g. by the command
+    //  batcher.
+    struct completion
+        : boost::noncopyable
+    {
+        completion()
+            : done_(false)
+            , failed_(false)
+            , error_(saga::NoSuccess)
+        {
+        }
+
+        void set_done()
+        {
+            {
+                boost::mutex::scoped_lock lock(mtx_);
+                done_ = true;
+            }
+            cond_.notify_all();
+        }
+
+        void set_error(std::string const & message, saga::error error)
+        {
+            {
+                boost::mutex::scoped_lock lock(mtx_);
+                failed_ = true;
+                message_ = message;
+                error_ = error;
+                done_ = true;
+            }
+            cond_.notify_all();
+        }
+
+        bool is_done() const
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+            return done_;
+        }
+
+        //  Waits up to timeout seconds (forever, if negative) for completion.
+        //  Returns true if completed.
+        bool wait(double timeout = -1.) const
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+            if (done_ || 0. == timeout)
+                return done_;
+
+            if (0. > timeout)
+            {
+                while (!done_)
+                    cond_.wait(lock);
+                return true;
+            }
+
+            boost::xtime const deadline = detail::make_deadline(timeout);
+            while (!done_)
+                if (!cond_.timed_wait(lock, deadline))
+                    break;
+            return done_;
+        }
+
+        // Once done, retrieves the error, if the operation failed.
+        bool failed(std::string & message, saga::error & error) const
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+            if (failed_)
+            {
+                message = message_;
+                error = error_;
+            }
+            return failed_;
+        }
+
+    private:
+        mutable boost::mutex mtx_;
+        mutable boost::condition cond_;
+
+        bool done_;
+        bool failed_;
+        std::string message_;
+        saga::error error_;
+    };
+
+}}} // namespace saga::adaptors::condor
+
+#endif // include guard
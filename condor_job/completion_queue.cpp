@@ -0,0 +1,209 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "completion_queue.hpp"
+#include "clock.hpp"
+
+#include <boost/config.hpp>
+
+#if defined(__linux__)
+#   include <sys/eventfd.h>
+#   include <unistd.h>
+#elif !defined(BOOST_WINDOWS)
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+#include <algorithm>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    completion_queue::completion_queue(std::size_t max_size)
+        : max_size_(max_size ? max_size : 1)
+        , dropped_(0)
+        , read_fd_(-1)
+        , write_fd_(-1)
+    {
+#if defined(__linux__)
+        read_fd_ = write_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#elif !defined(BOOST_WINDOWS)
+        int fds[2];
+        if (0 == pipe(fds))
+        {
+            for (int i = 0; i < 2; ++i)
+            {
+                fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+                fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+            }
+
+            read_fd_ = fds[0];
+            write_fd_ = fds[1];
+        }
+#endif
+    }
+
+    completion_queue::~completion_queue()
+    {
+#if !defined(BOOST_WINDOWS)
+        if (-1 != read_fd_)
+            close(read_fd_);
+        if (-1 != write_fd_ && write_fd_ != read_fd_)
+            close(write_fd_);
+#endif
+    }
+
+    void completion_queue::push(entry const & e)
+    {
+        {
+            scoped_lock lock(mtx_);
+
+            if (entries_.size() >= max_size_)
+            {
+                entries_.pop_front();
+                ++dropped_;
+            }
+
+            entries_.push_back(e);
+            if (1 == entries_.size())
+                signal_fd();
+        }
+
+        pushed_.notify_all();
+    }
+
+    std::size_t completion_queue::drain(std::vector<entry> & out,
+            std::size_t max)
+    {
+        scoped_lock lock(mtx_);
+
+        std::size_t count = (std::min)(max, entries_.size());
+        out.insert(out.end(), entries_.begin(), entries_.begin() + count);
+        entries_.erase(entries_.begin(), entries_.begin() + count);
+
+        if (count && entries_.empty())
+            clear_fd();
+
+        return count;
+    }
+
+    bool completion_queue::wait_any(entry & e, double timeout)
+    {
+        boost::xtime const deadline
+            = detail::make_deadline((std::max)(timeout, 0.));
+
+        scoped_lock lock(mtx_);
+        while (entries_.empty())
+            if (0. == timeout
+                    || !wait_for_push(lock, 0. < timeout, deadline))
+                return false;
+
+        e = entries_.front();
+        entries_.pop_front();
+
+        if (entries_.empty())
+            clear_fd();
+
+        return true;
+    }
+
+    bool completion_queue::wait_all(std::set<std::string> const & job_ids,
+            std::vector<entry> & out, double timeout)
+    {
+        boost::xtime const deadline
+            = detail::make_deadline((std::max)(timeout, 0.));
+
+        std::set<std::string> pending(job_ids);
+
+        scoped_lock lock(mtx_);
+        for (;;)
+        {
+            std::deque<entry>::iterator it = entries_.begin();
+            while (it != entries_.end())
+            {
+                if (pending.erase((*it).job_id))
+                {
+                    out.push_back(*it);
+                    it = entries_.erase(it);
+                }
+                else
+                    ++it;
+            }
+
+            if (entries_.empty())
+                clear_fd();
+
+            if (pending.empty())
+                return true;
+
+            if (0. == timeout || !wait_for_push(lock, 0. < timeout, deadline))
+                return false;
+        }
+    }
+
+    std::size_t completion_queue::size() const
+    {
+        scoped_lock lock(mtx_);
+        return entries_.size();
+    }
+
+    std::size_t completion_queue::get_dropped() const
+    {
+        scoped_lock lock(mtx_);
+        return dropped_;
+    }
+
+    bool completion_queue::wait_for_push(scoped_lock & lock,
+            bool has_deadline, boost::xtime const & deadline)
+    {
+        if (!has_deadline)
+        {
+            pushed_.wait(lock);
+            return true;
+        }
+
+        return pushed_.timed_wait(lock, deadline);
+    }
+
+    // Called with the queue locked, as it becomes non-empty.
+    void completion_queue::signal_fd()
+    {
+#if defined(__linux__)
+        if (-1 != write_fd_)
+        {
+            eventfd_t const one = 1;
+            ssize_t written = write(write_fd_, &one, sizeof(one));
+            (void)written;
+        }
+#elif !defined(BOOST_WINDOWS)
+        if (-1 != write_fd_)
+        {
+            char const byte = 0;
+            ssize_t written = write(write_fd_, &byte, 1);
+            (void)written;
+        }
+#endif
+    }
+
+    // Called with the queue locked, as it becomes empty.
+    void completion_queue::clear_fd()
+    {
+#if defined(__linux__)
+        if (-1 != read_fd_)
+        {
+            eventfd_t value;
+            ssize_t count = read(read_fd_, &value, sizeof(value));
+            (void)count;
+        }
+#elif !defined(BOOST_WINDOWS)
+        if (-1 != read_fd_)
+        {
+            char buffer[64];
+            while (0 < read(read_fd_, buffer, sizeof(buffer)))
+                /* Nothing to do */;
+        }
+#endif
+    }
+
+}}} // namespace saga::adaptors::condor
@@ -0,0 +1,111 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_COMPLETION_QUEUE_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_COMPLETION_QUEUE_HPP
+
+#include <saga/saga/packages/job/job.hpp>
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/xtime.hpp>
+
+#include <deque>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    //  Jobs of a pool reaching a final state (Done, Failed or Canceled), in
+    //  the order the log processor reports them. Allows waiting on many
+    //  jobs at once, without a thread per job.
+    //
+    //  The queue is created along with its pool. Only jobs with a job ID
+    //  are reported (i.e., not jobs canceled while waiting for admission).
+    //
+    //  The queue holds up to max_size entries. Once full, the oldest entry
+    //  is dropped for each new one, so that a queue nobody drains doesn't
+    //  grow without bound. Dropped entries are counted.
+    //
+    //  A file descriptor, readable while the queue is not empty, is
+    //  provided for use with select/poll. It is an eventfd on Linux, the
+    //  read end of a pipe elsewhere; the queue reads from it, callers should
+    //  only poll it.
+    struct completion_queue
+        : boost::noncopyable
+    {
+        struct entry
+        {
+            entry()
+                : state(saga::job::Unknown)
+                , exit_code(0)
+            {
+            }
+
+            std::string job_id;
+            saga::job::state state;
+            int exit_code;
+        };
+
+        explicit completion_queue(std::size_t max_size = 100000);
+        ~completion_queue();
+
+        // Called by the log processor, with the job locked.
+        void push(entry const & e);
+
+        //  Moves up to max entries to out, without blocking. Returns the
+        //  number of entries moved.
+        std::size_t drain(std::vector<entry> & out,
+            std::size_t max = std::size_t(-1));
+
+        //  Waits up to timeout seconds (forever, if negative) for a job to
+        //  finish, and takes its entry off the queue. Returns false on
+        //  timeout.
+        bool wait_any(entry & e, double timeout = -1.);
+
+        //  Waits up to timeout seconds (forever, if negative) for all jobs in
+        //  job_ids to finish. Their entries are moved to out as they come in,
+        //  entries of other jobs are left in the queue. Returns false on
+        //  timeout, with the entries gathered so far.
+        bool wait_all(std::set<std::string> const & job_ids,
+            std::vector<entry> & out, double timeout = -1.);
+
+        std::size_t size() const;
+
+        // Entries dropped so far, for lack of room.
+        std::size_t get_dropped() const;
+
+        // -1 if not available.
+        int get_fd() const
+        {
+            return read_fd_;
+        }
+
+    private:
+        typedef boost::mutex::scoped_lock scoped_lock;
+
+        // Blocks until the queue changes or the deadline expires. Returns
+        // false on timeout.
+        bool wait_for_push(scoped_lock & lock, bool has_deadline,
+            boost::xtime const & deadline);
+
+        void signal_fd();
+        void clear_fd();
+
+        mutable boost::mutex mtx_;
+        boost::condition pushed_;
+        std::deque<entry> entries_;
+        std::size_t const max_size_;
+        std::size_t dropped_;
+
+        int read_fd_;
+        int write_fd_;
+    };
+
+}}} // namespace saga::adaptors::condor
+
+#endif // include guard
@@ -4,25 +4,21 @@
 //  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
 #include "classad.hpp"
+#include "clock.hpp"
 #include "condor_job.hpp"
 #include "condor_job_adaptor.hpp"
 #include "description.hpp"
 #include "helper.hpp"
+#include "parallel_parser.hpp"
 #include "status.hpp"
+#include "task_bundler.hpp"
 
 #include <saga/saga-defs.hpp>
 
 #include <boost/bind.hpp>
-#include <boost/process.hpp>
-#include <boost/regex.hpp>
 
-///////////////////////////////////////////////////////////////////////////////
-//  this is a hack to make boost::process work (avoid multiple definitions)
-//  (this will go away as soon as it is fixed in Boost.Process)
-#if defined(BOOST_PROCESS_WIN32_API)
-const boost::process::detail::file_handle::handle_type 
-    boost::process::detail::file_handle::INVALID_VALUE = INVALID_HANDLE_VALUE;
-#endif
+#include <algorithm>
+#include <fstream>
 
 namespace saga { namespace adaptors { namespace condor {
 
@@ -33,6 +29,155 @@ namespace saga { namespace adaptors { namespace condor {
         job_data_->instances.erase(this);
     }
 
+    namespace {
+
+        //  State of a process, from its ClassAd. Process -1 if the ClassAd
+        //  doesn't have one.
+        struct proc_entry
+        {
+            proc_entry()
+                : proc(-1)
+                , state(proc_table::idle)
+                , exit_code(0)
+            {
+            }
+
+            long proc;
+            proc_table::proc_state state;
+            int exit_code;
+        };
+
+        proc_entry get_proc_entry(::condor::job::classad const & ca)
+        {
+            boost::optional< ::condor::job::classad::value>
+                proc        = ca.get_attribute("ProcId"),
+                status      = ca.get_attribute("JobStatus"),
+                exit_code   = ca.get_attribute("ExitCode");
+
+            proc_entry entry;
+            if (!proc || !status)
+                return entry;
+
+            try
+            {
+                entry.state = proc_table::from_status(
+                    ::condor::job::status(status->value_).get_status());
+                entry.exit_code = exit_code
+                    ? boost::lexical_cast<int>(exit_code->value_) : 0;
+                entry.proc = boost::lexical_cast<long>(proc->value_);
+            }
+            catch (boost::bad_lexical_cast const &)
+            {
+                entry.proc = -1;
+            }
+
+            return entry;
+        }
+
+        //  Fills procs with the states of all processes listed in the output
+        //  of condor_q. Single-process clusters leave procs empty.
+        //
+        //  Output for large clusters is parsed on several threads.
+        void get_process_states(std::string const & output, proc_table & procs)
+        {
+            std::vector<proc_entry> entries;
+            parallel_parser().parse(output, &get_proc_entry, entries);
+
+            proc_table table;
+            for (std::size_t i = 0; i < entries.size(); ++i)
+                if (entries[i].proc >= 0)
+                    table.set(std::size_t(entries[i].proc), entries[i].state,
+                        entries[i].exit_code);
+
+            if (table.size() > 1)
+                procs = table;
+        }
+
+    } // namespace
+
+    void job_cpi_impl::get_classad(std::string const & rm,
+            std::string const & id, std::string const & jobid,
+            double not_before, std::string & output,
+            ::condor::job::classad & ca, double & taken)
+    {
+        taken = -1.;
+
+        try
+        {
+            std::vector<std::string> args;
+            args.push_back("-xml");
+            args.push_back(id);
+
+            // Jobs reconnecting together share a snapshot of the queue. Jobs
+            // not in it (e.g., submitted since) are queried on their own.
+            //
+            // Ignoring exit status. Will try to process output and see if we
+            // can get the job's ClassAd.
+            if (!get_adaptor()->get_queue_cache(rm)->get_job(id, output,
+                    taken, not_before))
+                output = get_adaptor()->run_condor_query(
+                    "condor_q", args).output;
+        }
+        catch (std::exception const & e)
+        {
+            SAGA_ADAPTOR_THROW("Couldn't get job status for job ID " + jobid
+                + ": std::exception caught: " + e.what() + ".",
+                saga::BadParameter);
+        }
+
+        // Parse classad from condor_q
+        if (!ca.find_and_parse(output))
+        {
+            // Jobs that finished meanwhile are in the history.
+            bool finished;
+            try
+            {
+                finished = get_adaptor()->get_history_cache(rm)
+                    ->get_job(id, output);
+            }
+            catch (std::exception const & e)
+            {
+                SAGA_ADAPTOR_THROW("Couldn't get job history for job ID "
+                    + jobid + ": std::exception caught: " + e.what() + ".",
+                    saga::NoSuccess);
+            }
+
+            if (!finished || !ca.find_and_parse(output))
+                SAGA_ADAPTOR_THROW("Job not found: " + jobid + ".",
+                    saga::DoesNotExist);
+        }
+    }
+
+    void job_cpi_impl::attach_to_process(std::string const & rm,
+            std::string const & id)
+    {
+        std::string::size_type dot = id.find('.');
+        if (std::string::npos == dot)
+            return;
+
+        int proc = -1;
+        try
+        {
+            proc = boost::lexical_cast<int>(id.substr(dot + 1));
+        }
+        catch (boost::bad_lexical_cast const &)
+        {
+            return;
+        }
+
+        boost::shared_ptr<shared_job_data> cluster
+            = get_adaptor()->find_job(rm, id.substr(0, dot));
+        if (!cluster || proc < 0)
+            return;
+
+        shared_job_data::scoped_lock lock(cluster->state_change_mtx);
+        if (static_cast<std::size_t>(proc) < cluster->procs.size())
+        {
+            job_data_ = cluster;
+            proc_ = proc;
+        }
+    }
+
     void job_cpi_impl::set_job_id()
     {
         using namespace saga::job::attributes;
@@ -45,7 +190,7 @@ namespace saga { namespace adaptors { namespace condor {
                     || job_data_->full_job_id.empty())
                 && "Error: Tried to reset previously set job ID.");
 
-            attr.set_attribute(jobid, job_data_->full_job_id);
+            attr.set_attribute(jobid, get_job_id());
         }
 
         if (!job_data_->full_job_id.empty()
@@ -59,6 +204,7 @@ namespace saga { namespace adaptors { namespace condor {
             TR1::shared_ptr<saga::adaptor> adaptor)
         : base_cpi(p, info, adaptor, cpi::Noflags)
         , proxy_lock_(p->shared_from_this())
+        , proc_(-1)
         , state_changed_(false)
         , cached_state_(saga::job::New)
     {
@@ -79,6 +225,8 @@ namespace saga { namespace adaptors { namespace condor {
             SAGA_ADAPTOR_THROW("Job has been started already!",
                 saga::IncorrectState);
 
+        status_poller * poller = 0;
+
         {
             instance_data data(this);
 
@@ -101,68 +249,67 @@ namespace saga { namespace adaptors { namespace condor {
                 }
 
                 job_data_ = get_adaptor()->find_job(rm, id);
+                if (!job_data_)
+                    attach_to_process(rm, id);
                 if (!job_data_)
                 {
                     job_data_.reset(new shared_job_data());
 
                     std::string output;
-
-                    try
-                    {
-                        std::vector<std::string> args;
-                        args.push_back("-xml");
-                        args.push_back(id);
-
-                        boost::process::child c =
-                            get_adaptor()->run_condor_command("condor_q",
-                                args, boost::process::close_stream);
-
-                        boost::process::pistream & out = c.get_stdout();
-                        for (std::string line; getline(out, line);
-                                output += line + "\n")
-                            /* Nothing to do */;
-
-                        // Ignoring exit status. Will try to process output and
-                        // see if we can get the job's ClassAd.
-                        c.wait();
-                    }
-                    catch (std::exception const & e)
-                    {
-                        SAGA_ADAPTOR_THROW("Couldn't get job status for job ID "
-                                + data->jobid_ + ": std::exception caught: " +
-                                e.what() + ".", saga::BadParameter);
-                    }
-
-                    // Parse classad from condor_q
                     ::condor::job::classad ca;
-                    if (!ca.find_and_parse(output))
-                        SAGA_ADAPTOR_THROW("Job not found: " + data->jobid_
-                            + ".", saga::DoesNotExist);
+                    double taken;
+                    get_classad(rm, id, data->jobid_, -1., output, ca, taken);
 
                     {
                         boost::optional< ::condor::job::classad::value>
-                            status  = ca.get_attribute("JobStatus"),
                             log     = ca.get_attribute("UserLog"),
                             log_xml = ca.get_attribute("UserLogUseXML");
 
-                        job_data_->state = status
-                            ? ::condor::job::status(status->value_)
-                            : saga::job::Running;   // assume a running job
+                        // The log may be on another host, or not readable
+                        // by us.
+                        bool const has_log = log && !log->value_.empty()
+                            && log_xml && "t" == log_xml->value_
+                            && std::ifstream(log->value_.c_str());
 
-                        if (log && !log->value_.empty()
-                                && log_xml && "t" == log_xml->value_)
+                        if (has_log)
                         {
                             job_data_->pool_ = get_adaptor()->get_pool(
                                     rm, log->value_);
 
                             // Start log processing
                             job_data_->pool_->get_log();
+
+                            // The log is processed from its end, so jobs
+                            // finishing before then are never seen to. Only
+                            // snapshots taken since can be trusted.
+                            double const started
+                                = job_data_->pool_->get_log_start();
+                            if (taken >= 0. && taken < started)
+                                get_classad(rm, id, data->jobid_, started,
+                                    output, ca, taken);
                         }
                         else
                             job_data_->pool_ = get_adaptor()->get_pool(
                                     rm, "//-- No XML Log --//");
+
+                        boost::optional< ::condor::job::classad::value>
+                            status = ca.get_attribute("JobStatus");
+
+                        job_data_->state = status
+                            ? ::condor::job::status(status->value_)
+                            : saga::job::Running;   // assume a running job
+
+                        // Track state by polling Condor instead
+                        if (!has_log && !job_data_->is_state_final())
+                            poller = &job_data_->pool_->get_status_poller(
+                                    *get_adaptor());
                     }
 
+                    // condor_q (and condor_history) list every process in a
+                    // cluster.
+                    if (std::string::npos == id.find('.'))
+                        get_process_states(output, job_data_->procs);
+
                     job_data_->cluster_id = id;
                     job_data_->full_job_id = data->jobid_;
                     job_data_->description = detail::condor_to_saga(ca);
@@ -202,9 +349,13 @@ namespace saga { namespace adaptors { namespace condor {
             // Update status and start receiving events
             shared_job_data::scoped_lock lock(job_data_->state_change_mtx);
 
-            update_state(job_data_->state, job_data_->attributes);
+            update_state(*job_data_, -1);
             job_data_->instances.insert(this);
         }
+
+        // Registered now, have it polled.
+        if (poller)
+            poller->wake();
     }
 
     void job_cpi_impl::sync_get_state(saga::job::state& state)
@@ -230,64 +381,32 @@ namespace saga { namespace adaptors { namespace condor {
         // time? Need some kind of lock here.
 
         // Verify job hasn't been started.
-        if (saga::job::New != get_state())
+        if (saga::job::New != get_state() || job_data_->queued)
             SAGA_ADAPTOR_THROW("Job has been started already!",
                     saga::IncorrectState);
         if (!job_data_->cluster_id.empty())
             SAGA_ADAPTOR_THROW("Condor cluster ID has already been set.",
                     saga::IncorrectState);
 
-        std::vector<std::string> args;
-        args.push_back("-append");
-        args.push_back("log = " + job_data_->pool_->get_log());
-        args.push_back("-append");
-        args.push_back("log_xml = True");
-
-        std::string output;
-
-        // Prevent processing of events, so we don't lose any...
-        synchronized<job_registry>::lock lck(job_data_->pool_->get_registry());
+        ::condor::job::description desc;
+        task_bundler::task task;
+        dag_submitter::node node;
 
         try
         {
-            ::condor::job::description desc;
-            {
-                instance_data data(this);
-
-                BOOST_ASSERT(data->jd_is_valid_);
-                desc = detail::saga_to_condor(data->jd_,
-                        data->rm_,
-                        this->proxy_->get_session().list_contexts(),
-                        get_adaptor()->get_default_job_attributes());
-            }
-
-            boost::process::child c =
-                get_adaptor()->run_condor_command("condor_submit", args);
-            args.clear();
-
-            boost::process::postream & in = c.get_stdin();
-            boost::process::pistream & out = c.get_stdout();
-
-            std::stringstream os;
-                os << " ** Condor adaptor (job::run)\n"
-                    "    About to submit job description:\n"
-                    "========================================\n"
-                    << desc
-                    << "========================================\n";
-            
-            SAGA_LOG_DEBUG(os.str());
-
-            in << desc << std::flush;
-            in.close();
-
-            for (std::string line; getline(out, line); output += "\n  " + line)
-                /* Nothing to do */;
+            instance_data data(this);
 
-            boost::process::status status = c.wait();
-            if (!status.exited() || status.exit_status())
-                SAGA_ADAPTOR_THROW("Failed to submit job to condor pool. "
-                    "Output from condor_submit follows:\n" + output,
-                    saga::NoSuccess);
+            BOOST_ASSERT(data->jd_is_valid_);
+            desc = detail::saga_to_condor(data->jd_,
+                    data->rm_,
+                    this->proxy_->get_session().list_contexts(),
+                    get_adaptor()->get_default_job_attributes());
+
+            if (dag_submitter::is_dag_node(data->jd_))
+                node = dag_submitter::make_node(data->jd_, job_data_);
+            else if (get_adaptor()->get_bundling_config().enabled
+                    && task_bundler::is_bundleable(desc))
+                task = task_bundler::make_task(data->jd_, job_data_);
         }
         catch (saga::adaptors::exception const &)
         {
@@ -301,37 +420,120 @@ namespace saga { namespace adaptors { namespace condor {
                 saga::BadParameter);
         }
 
-        shared_job_data::scoped_lock lock(job_data_->state_change_mtx);
-        job_data_->state = saga::job::Running;
-
-        static const boost::regex re(
-            "^  \\d+ job\\(s\\) submitted to cluster (\\d+).");
-        boost::smatch match;
-        if (regex_search(output, match, re))
-            job_data_->cluster_id = match.str(1);
-        else
+        if (node.job)
+        {
+            run_dag_node(desc, node);
+            return;
+        }
+
+        if (task.job)
+        {
+            run_bundled(desc, task);
+            return;
+        }
+
+        admission_controller * controller = 0;
+        if (get_adaptor()->get_flow_control_config().max_idle)
+        {
+            controller = &job_data_->pool_->get_admission_controller(
+                *get_adaptor());
+
+            // Submitted later, as the pool drains.
+            if (!controller->admit(desc, job_data_))
+                return;
+        }
+
+        std::string output;
+        std::string cluster_id;
+        std::size_t processes = 0;
+
+        try
         {
-            // Job submission was successful and job should have started, since
-            // condor_submit exited normally. Somehow, we failed to grab Cluster
-            // ID from the output of condor_submit.
-            // If we throw, other adaptors would be attempted :-/
-            std::string msg = "Failed to determine Cluster ID from the output "
-                "of condor_submit (see below). Won't be able to perform "
-                "further operations on the job.\n" + output;
-            SAGA_LOG_WARN(output.c_str())
-
-            job_data_->cluster_id = "Unknown";
+            // Returns with the registry locked, events are held back.
+            synchronized<job_registry>::lock lck = get_adaptor()->submit(
+                *job_data_->pool_, desc, cluster_id, output, &processes);
+
+            // As reported by condor_submit, if it did.
+            if (!processes)
+                processes = desc.get_process_count();
+            else if (controller)
+                controller->idle_changed(
+                    long(processes) - long(desc.get_process_count()));
+
+            shared_job_data::scoped_lock lock(job_data_->state_change_mtx);
+            job_data_->state = saga::job::Running;
+            if (processes > 1)
+                job_data_->procs.resize(processes);
+
+            if (controller)
+            {
+                job_data_->flow_controlled = true;
+                job_data_->idle_procs = processes;
+            }
+
+            if (!cluster_id.empty())
+                job_data_->cluster_id = cluster_id;
+            else
+            {
+                // Job submission was successful and job should have started,
+                // since condor_submit exited normally. Somehow, we failed to
+                // grab Cluster ID from the output of condor_submit.
+                // If we throw, other adaptors would be attempted :-/
+                std::string msg = "Failed to determine Cluster ID from the "
+                    "output of condor_submit (see below). Won't be able to "
+                    "perform further operations on the job.\n" + output;
+                SAGA_LOG_WARN(msg.c_str())
+
+                job_data_->cluster_id = "Unknown";
+            }
+
+            job_data_->full_job_id = std::string("[")
+                + job_data_->pool_->get_url() + "]-["
+                + job_data_->cluster_id + "]";
+
+            set_job_id();
+            update_state(*job_data_, -1);
+        }
+        catch (...)
+        {
+            // Give back the room taken by the job.
+            if (controller)
+                controller->idle_changed(-long(desc.get_process_count()));
+            throw;
         }
+    }
+
+    void job_cpi_impl::run_bundled(::condor::job::description const & desc,
+            task_bundler::task const & task)
+    {
+        // Blocks until the bundle holding the task is submitted.
+        job_data_->pool_->get_bundler(*get_adaptor()).submit(desc, task);
+
+        shared_job_data::scoped_lock lock(job_data_->state_change_mtx);
+
+        set_job_id();
+        update_state(*job_data_, -1);
+    }
 
-        job_data_->full_job_id = std::string("[") + job_data_->pool_->get_url()
-            + "]-[" + job_data_->cluster_id + "]";
+    void job_cpi_impl::run_dag_node(::condor::job::description const & desc,
+            dag_submitter::node const & node)
+    {
+        // Submits the DAG, once all of its nodes are in.
+        job_data_->pool_->get_dag_submitter(*get_adaptor()).add(desc, node);
+
+        shared_job_data::scoped_lock lock(job_data_->state_change_mtx);
 
         set_job_id();
-        update_state(job_data_->state, job_data_->attributes);
+        update_state(*job_data_, -1);
     }
 
     void job_cpi_impl::sync_cancel(saga::impl::void_t&, double timeout)
     {
+        // Jobs waiting for admission are simply dropped.
+        if (job_data_->queued && job_data_->pool_->get_admission_controller(
+                    *get_adaptor()).cancel(job_data_))
+            return;
+
         // Verify the job has started and we have a valid cluster ID for it.
         // No point in verifying the job is actually running, since it would
         // always be a race condition.
@@ -341,41 +543,15 @@ namespace saga { namespace adaptors { namespace condor {
         if (job_data_->cluster_id.empty())
             SAGA_ADAPTOR_THROW("Condor cluster ID is not known. "
                 "Can't cancel job.", saga::IncorrectState);
+        if (job_data_->is_bundled_task())
+            SAGA_ADAPTOR_THROW("Can't cancel a single task in a bundle of "
+                "jobs.", saga::NotImplemented);
 
         // Invoking sub-process takes time
-        boost::xtime t;
-        boost::xtime_get(&t, boost::TIME_UTC);
+        boost::xtime const deadline
+            = detail::make_deadline((std::max)(timeout, 0.));
 
-        try
-        {
-            std::vector<std::string> args;
-            args.push_back(job_data_->cluster_id);
-            boost::process::child c =
-                get_adaptor()->run_condor_command("condor_rm", args,
-                    boost::process::close_stream);
-
-            std::string output;
-            boost::process::pistream & out = c.get_stdout();
-            for (std::string line; getline(out, line); output += "\n  " + line)
-                /* Nothing to do */;
-            boost::process::status status = c.wait();
-            if (!status.exited() || status.exit_status())
-                SAGA_ADAPTOR_THROW("Failed to cancel condor job "
-                    "[" + job_data_->cluster_id + "]. "
-                    "Output from condor_rm follows:\n" + output,
-                    saga::NoSuccess);
-        }
-        catch (saga::adaptors::exception const &)
-        {
-            // Let our exceptions fall through.
-            throw;
-        }
-        catch (std::exception const & e)
-        {
-            SAGA_ADAPTOR_THROW("Problem cancelling condor job: "
-                "(std::exception caught: " + e.what() + ")",
-                saga::BadParameter);
-        }
+        run_batched("condor_rm");
 
         if (0. == timeout || is_state_final())
             return;
@@ -383,10 +559,7 @@ namespace saga { namespace adaptors { namespace condor {
         shared_job_data::scoped_lock lock(job_data_->state_change_mtx);
         if (0. < timeout)
         {
-            // TODO Allow for sub-second resolution where supported.
-            t.sec += static_cast<boost::xtime::xtime_sec_t>(timeout);
-
-            job_data_->state_change.timed_wait(lock, t,
+            job_data_->state_change.timed_wait(lock, deadline,
                 boost::bind(&job_cpi_impl::is_state_final, this));
         }
         else // 0. > timeout
@@ -394,17 +567,25 @@ namespace saga { namespace adaptors { namespace condor {
                 boost::bind(&job_cpi_impl::is_state_final, this));
     }
 
-    void job_cpi_impl::sync_wait(bool & finished, double timeout)
+    void job_cpi_impl::check_waitable() const
     {
         // Verify the job has started and we have a valid cluster ID for it.
         // No point in verifying the job is actually running, since it would
         // always be a race condition.
-        if (saga::job::New == get_state())
+        //
+        // Jobs waiting for admission, or DAG nodes not yet submitted by
+        // DAGMan, will be notified once they are.
+        if (saga::job::New == get_state() && !job_data_->queued)
             SAGA_ADAPTOR_THROW("Can't wait on a job that hasn't started.",
                 saga::IncorrectState);
-        if (job_data_->cluster_id.empty())
-            SAGA_ADAPTOR_THROW("Condor cluster ID is not known. "
+        if (job_data_->full_job_id.empty() && !job_data_->queued)
+            SAGA_ADAPTOR_THROW("Condor job ID is not known. "
                 "Can't wait on job.", saga::IncorrectState);
+    }
+
+    void job_cpi_impl::sync_wait(bool & finished, double timeout)
+    {
+        check_waitable();
 
         if ((finished = is_state_final()) || 0. == timeout)
             return;
@@ -412,13 +593,8 @@ namespace saga { namespace adaptors { namespace condor {
         shared_job_data::scoped_lock lock(job_data_->state_change_mtx);
         if (0. < timeout)
         {
-            boost::xtime t;
-            boost::xtime_get(&t, boost::TIME_UTC);
-
-            // TODO Allow for sub-second resolution where supported.
-            t.sec += static_cast<boost::xtime::xtime_sec_t>(timeout);
-
-            finished = job_data_->state_change.timed_wait(lock, t,
+            finished = job_data_->state_change.timed_wait(lock,
+                detail::make_deadline(timeout),
                 boost::bind(&job_cpi_impl::is_state_final, this));
         }
         else // 0. > timeout
@@ -431,19 +607,19 @@ namespace saga { namespace adaptors { namespace condor {
 
     void job_cpi_impl::sync_suspend(saga::impl::void_t&)
     {
-        // Verify the job has started and we have a valid cluster ID for it.
-        // No point in verifying the job is actually running, since it would
-        // always be a race condition.
-        if (saga::job::New == get_state())
-            SAGA_ADAPTOR_THROW("Can't suspend a job that hasn't started.",
+        // Verify the job is running and we have a valid cluster ID for it.
+        if (saga::job::Running != get_state())
+            SAGA_ADAPTOR_THROW("Can't suspend a job that isn't running.",
                 saga::IncorrectState);
         if (job_data_->cluster_id.empty())
             SAGA_ADAPTOR_THROW("Condor cluster ID is not known. "
                 "Can't suspend job.", saga::IncorrectState);
+        if (job_data_->is_bundled_task())
+            SAGA_ADAPTOR_THROW("Can't suspend a single task in a bundle of "
+                "jobs.", saga::NotImplemented);
 
-        // TODO
-        SAGA_ADAPTOR_THROW("Suspending jobs not implemented.",
-            saga::NotImplemented);
+        // The job becomes Suspended once the job log reports it held.
+        run_batched("condor_hold");
     }
 
     void job_cpi_impl::sync_resume(saga::impl::void_t&)
@@ -455,10 +631,26 @@ namespace saga { namespace adaptors { namespace condor {
         if (job_data_->cluster_id.empty())
             SAGA_ADAPTOR_THROW("Condor cluster ID is not known. "
                 "Can't resume job.", saga::IncorrectState);
+        if (job_data_->is_bundled_task())
+            SAGA_ADAPTOR_THROW("Can't resume a single task in a bundle of "
+                "jobs.", saga::NotImplemented);
 
-        // TODO
-        SAGA_ADAPTOR_THROW("Resuming jobs not implemented.",
-            saga::NotImplemented);
+        // The job is Running again once the job log reports it released.
+        run_batched("condor_release");
+    }
+
+    void job_cpi_impl::run_batched(std::string const & command)
+    {
+        // Run together with requests for other jobs.
+        boost::shared_ptr<completion> done = job_data_->pool_
+            ->get_command_batcher(*get_adaptor())
+            .post(command, get_condor_id());
+        done->wait();
+
+        std::string message;
+        saga::error error;
+        if (done->failed(message, error))
+            SAGA_ADAPTOR_THROW(message, error);
     }
 
 }}} // namespace saga::adaptors::condor
@@ -6,19 +6,29 @@
 #ifndef SAGA_ADAPTORS_CONDOR_JOB_CONDOR_JOB_HPP
 #define SAGA_ADAPTORS_CONDOR_JOB_CONDOR_JOB_HPP
 
+#include "admission_controller.hpp"
 #include "condor_job_adaptor.hpp"
+#include "dag_submitter.hpp"
 #include "pool_data.hpp"
 #include "shared_job_data.hpp"
+#include "task_bundler.hpp"
 
 #include <saga/saga/adaptors/attribute.hpp>
 #include <saga/impl/packages/job/job_cpi.hpp>
 
 #include <boost/assert.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/thread.hpp>
 
 #include <set>
 #include <string>
 
+namespace condor { namespace job {
+
+    struct classad;
+
+}} // namespace condor::job
+
 namespace saga { namespace adaptors { namespace condor {
 
     struct log_processor;
@@ -50,13 +60,53 @@ namespace saga { namespace adaptors { namespace condor {
         void sync_resume(saga::impl::void_t &);
 
     private:
+        void check_waitable() const;
+
+        //  Runs command (condor_rm, condor_hold or condor_release) on the
+        //  job, batched with other jobs in the pool. Throws on failure.
+        void run_batched(std::string const & command);
+
         std::string get_job_id()
         {
-            return job_data_->full_job_id;
+            if (proc_ < 0)
+                return job_data_->full_job_id;
+
+            return "[" + job_data_->pool_->get_url() + "]-["
+                + get_condor_id() + "]";
+        }
+
+        // Cluster ID, or "Cluster.Proc" for handles on a single process.
+        std::string get_condor_id() const
+        {
+            if (proc_ < 0)
+                return job_data_->cluster_id;
+
+            return job_data_->cluster_id + "."
+                + boost::lexical_cast<std::string>(proc_);
         }
 
         void set_job_id();
 
+        void run_bundled(::condor::job::description const & desc,
+            task_bundler::task const & task);
+        void run_dag_node(::condor::job::description const & desc,
+            dag_submitter::node const & node);
+
+        //  ClassAd of job id ("Cluster" or "Cluster.Proc") on rm, from the
+        //  queue or, for finished jobs, the history. Queue snapshots taken
+        //  before not_before are retaken. Sets taken to the time the
+        //  snapshot used was taken, or to -1 if none was. Throws if the job
+        //  isn't found; jobid is the SAGA job ID, for messages.
+        void get_classad(std::string const & rm, std::string const & id,
+            std::string const & jobid, double not_before,
+            std::string & output, ::condor::job::classad & ca,
+            double & taken);
+
+        // Processes of multi-process clusters we track share the cluster's
+        // data. Attaches this instance to process "Cluster.Proc" in id, if
+        // the cluster is known.
+        void attach_to_process(std::string const & rm, std::string const & id);
+
         bool is_state_final() const
         {
             saga::job::state state = get_state();
@@ -70,7 +120,9 @@ namespace saga { namespace adaptors { namespace condor {
             if (state_changed_)
             {
                 shared_job_data::scoped_lock lock(job_data_->state_change_mtx);
-                cached_state_ = job_data_->state;
+                cached_state_ = proc_ < 0
+                    ? job_data_->state
+                    : proc_table::to_saga_state(job_data_->procs.get(proc_));
                 state_changed_ = false;
             }
 
@@ -113,6 +165,30 @@ namespace saga { namespace adaptors { namespace condor {
             state_changed_ = true;
         }
 
+        // Called with job_data locked. proc identifies the process an update
+        // refers to in multi-process clusters, -1 otherwise.
+        void update_state(shared_job_data const & job_data, int proc)
+        {
+            if (proc_ < 0)
+            {
+                update_state(job_data.state, job_data.attributes);
+                return;
+            }
+
+            if (proc >= 0 && proc != proc_)
+                return;
+
+            proc_table::proc_state state = job_data.procs.get(proc_);
+
+            shared_job_data::attribute_map attributes;
+            if (proc_table::done == state || proc_table::failed == state)
+                attributes[saga::job::attributes::exitcode]
+                    = boost::lexical_cast<std::string>(
+                        job_data.procs.get_exit_code(proc_));
+
+            update_state(proc_table::to_saga_state(state), attributes);
+        }
+
         boost::shared_ptr<job_adaptor> get_adaptor() const
         {
             return TR1::static_pointer_cast<job_adaptor>(
@@ -120,6 +196,7 @@ namespace saga { namespace adaptors { namespace condor {
         }
 
         boost::shared_ptr<shared_job_data> job_data_;
+        int proc_;  // ProcId for handles on a single process, or -1.
         volatile mutable bool state_changed_;
         mutable saga::job::state cached_state_;
     };
@@ -5,13 +5,113 @@
 
 #include "condor_job_adaptor.hpp"
 
+#include "clock.hpp"
 #include "condor_job_service.hpp"
 #include "condor_job.hpp"
+#include "description.hpp"
 
 #include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/regex.hpp>
+
+#include <algorithm>
+#include <sstream>
 
 namespace saga { namespace adaptors { namespace condor {
 
+    namespace {
+
+        template <class T>
+        T get_entry(saga::ini::ini const & ini, std::string const & key,
+                T const & default_value)
+        {
+            try
+            {
+                return boost::lexical_cast<T>(ini.get_entry(key,
+                    boost::lexical_cast<std::string>(default_value)));
+            }
+            catch (boost::bad_lexical_cast const &)
+            {
+                return default_value;
+            }
+        }
+
+        bool get_flag(saga::ini::ini const & ini, std::string const & key,
+                bool default_value)
+        {
+            std::string value = ini.get_entry(key, "");
+            if (value.empty())
+                return default_value;
+
+            return boost::iequals(value, "true")
+                || boost::iequals(value, "yes")
+                || "1" == value;
+        }
+
+        std::string get_submitted_cluster(std::string const & output)
+        {
+            static const boost::regex re(
+                "^  \\d+ job\\(s\\) submitted to cluster (\\d+).");
+            boost::smatch match;
+            if (regex_search(output, match, re))
+                return match.str(1);
+
+            return std::string();
+        }
+
+        //  As above, for condor_submit -terse, which reports the range of
+        //  job IDs submitted ("Cluster.First - Cluster.Last"). Falls back to
+        //  the verbose report. Sets processes to the number of processes
+        //  submitted, 0 if unknown.
+        std::string get_submitted_jobs(std::string const & output,
+            std::size_t & processes)
+        {
+            static const boost::regex terse_re(
+                "^\\s*(\\d+)\\.(\\d+) - (\\d+)\\.(\\d+)\\s*$");
+            static const boost::regex verbose_re(
+                "^  (\\d+) job\\(s\\) submitted to cluster (\\d+).");
+
+            processes = 0;
+
+            boost::smatch match;
+            try
+            {
+                if (regex_search(output, match, terse_re)
+                        && match.str(1) == match.str(3))
+                {
+                    std::size_t const first
+                        = boost::lexical_cast<std::size_t>(match.str(2));
+                    std::size_t const last
+                        = boost::lexical_cast<std::size_t>(match.str(4));
+                    if (first <= last)
+                        processes = last - first + 1;
+                    return match.str(1);
+                }
+
+                if (regex_search(output, match, verbose_re))
+                {
+                    processes = boost::lexical_cast<std::size_t>(match.str(1));
+                    return match.str(2);
+                }
+            }
+            catch (boost::bad_lexical_cast const &)
+            {
+            }
+
+            return std::string();
+        }
+
+        // Submit description, as condor_submit reads it.
+        void write_description(::condor::job::description const & desc,
+                std::ostream & os)
+        {
+            os << desc;
+        }
+
+    } // namespace
+
     SAGA_ADAPTOR_REGISTER(job_adaptor)
 
     saga::impl::adaptor_selector::adaptor_info_list_type
@@ -60,7 +160,9 @@ namespace saga { namespace adaptors { namespace condor {
             saga::ini::ini cli = adap_ini.get_section("cli");
 
             binary_path_ = cli.get_entry("binary_path", "");
+            cmd_launcher_.set_search_path(binary_path_);
             condor_log_ = cli.get_entry("condor_log", "");
+            terse_submit_ = get_flag(cli, "terse_submit", terse_submit_);
             std::string env = cli.get_entry("environment", "environment");
 
             if (!env.empty() && cli.has_section_full(env))
@@ -91,38 +193,375 @@ namespace saga { namespace adaptors { namespace condor {
             }
         }
 
+        // Task bundling
+        if (adap_ini.has_section("bundling"))
+        {
+            saga::ini::ini bundling = adap_ini.get_section("bundling");
+
+            bundling_.enabled = get_flag(bundling, "enabled", false);
+            bundling_.max_tasks = (std::max)(std::size_t(1),
+                get_entry(bundling, "max_tasks", bundling_.max_tasks));
+            bundling_.max_delay =
+                get_entry(bundling, "max_delay", bundling_.max_delay);
+            bundling_.parallel = (std::max)(std::size_t(1),
+                get_entry(bundling, "parallel", bundling_.parallel));
+        }
+
+        // Pacing of condor_submit
+        if (adap_ini.has_section("submit_control"))
+        {
+            saga::ini::ini submit_control
+                = adap_ini.get_section("submit_control");
+
+            submit_control_.enabled = get_flag(submit_control, "enabled",
+                submit_control_.enabled);
+            submit_control_.max_rate = get_entry(submit_control, "max_rate",
+                submit_control_.max_rate);
+            submit_control_.min_rate = get_entry(submit_control, "min_rate",
+                submit_control_.min_rate);
+            submit_control_.target_latency = get_entry(submit_control,
+                "target_latency", submit_control_.target_latency);
+            submit_control_.max_retries = get_entry(submit_control,
+                "max_retries", submit_control_.max_retries);
+            submit_control_.backoff = get_entry(submit_control, "backoff",
+                submit_control_.backoff);
+            submit_control_.max_backoff = get_entry(submit_control,
+                "max_backoff", submit_control_.max_backoff);
+
+            if (!(submit_control_.max_rate > 0.))
+                submit_control_.max_rate = submit_governor::config().max_rate;
+            submit_control_.min_rate = (std::min)(submit_control_.max_rate,
+                (std::max)(submit_control_.min_rate, .001));
+        }
+
+        // Batching of condor_rm, condor_hold and condor_release
+        if (adap_ini.has_section("batching"))
+        {
+            saga::ini::ini batching = adap_ini.get_section("batching");
+
+            batching_.max_delay = (std::max)(0.,
+                get_entry(batching, "max_delay", batching_.max_delay));
+            batching_.max_jobs = (std::max)(std::size_t(1),
+                get_entry(batching, "max_jobs", batching_.max_jobs));
+        }
+
+        // Flow control
+        if (adap_ini.has_section("flow_control"))
+        {
+            saga::ini::ini flow_control = adap_ini.get_section("flow_control");
+
+            flow_control_.max_idle = get_entry(flow_control, "max_idle",
+                flow_control_.max_idle);
+        }
+
+        // Invocation of Condor commands
+        if (adap_ini.has_section("command_control"))
+        {
+            saga::ini::ini command_control
+                = adap_ini.get_section("command_control");
+
+            command_control_.max_concurrent = get_entry(command_control,
+                "max_concurrent", command_control_.max_concurrent);
+            command_control_.timeout = get_entry(command_control, "timeout",
+                command_control_.timeout);
+
+            std::string limits
+                = command_control.get_entry("limits", "limits");
+            if (!limits.empty() && command_control.has_section_full(limits))
+            {
+                saga::ini::ini limits_section
+                    = command_control.get_section(limits);
+
+                typedef saga::ini::entry_map entry_map;
+
+                entry_map const& entries = limits_section.get_entries();
+                entry_map::const_iterator end = entries.end();
+                for (entry_map::const_iterator it = entries.begin();
+                        it != end; ++it)
+                    command_control_.limits[(*it).first] = get_entry(
+                        limits_section, (*it).first,
+                        command_control_.max_concurrent);
+            }
+        }
+
+        // Snapshots of job queues
+        if (adap_ini.has_section("queue_cache"))
+        {
+            saga::ini::ini queue_cache = adap_ini.get_section("queue_cache");
+
+            queue_caching_.ttl = (std::max)(0.,
+                get_entry(queue_cache, "ttl", queue_caching_.ttl));
+        }
+
+        // Finished jobs, from condor_history
+        if (adap_ini.has_section("history_cache"))
+        {
+            saga::ini::ini history_cache
+                = adap_ini.get_section("history_cache");
+
+            history_caching_.capacity = get_entry(history_cache, "capacity",
+                history_caching_.capacity);
+        }
+
+        // Job listing
+        if (adap_ini.has_section("listing"))
+        {
+            saga::ini::ini listing = adap_ini.get_section("listing");
+
+            listing_.owner = listing.get_entry("owner", listing_.owner);
+            listing_.session_tag
+                = listing.get_entry("session_tag", listing_.session_tag);
+            listing_.page_size = get_entry(listing, "page_size",
+                listing_.page_size);
+            listing_.processes = get_flag(listing, "processes",
+                listing_.processes);
+
+            std::istringstream states(listing.get_entry("states", ""));
+            for (std::string state; states >> state; )
+            {
+                int const code = job_lister::get_state_code(state);
+                if (code < 0)
+                {
+                    SAGA_LOG_WARN(("Condor adaptor: Ignoring unknown job "
+                        "state in [listing] states: " + state).c_str());
+                }
+                else
+                    listing_.states.insert(code);
+            }
+        }
+
+        // Polling for jobs without a readable log
+        if (adap_ini.has_section("polling"))
+        {
+            saga::ini::ini polling = adap_ini.get_section("polling");
+
+            polling_.min_interval = (std::max)(1.,
+                get_entry(polling, "min_interval", polling_.min_interval));
+            polling_.max_interval = (std::max)(polling_.min_interval,
+                get_entry(polling, "max_interval", polling_.max_interval));
+        }
+
+        cmd_scheduler_.reset(
+            new command_scheduler(cmd_launcher_, command_control_));
+
         initialized_ = true;
         return true;
     }
 
-    boost::process::child job_adaptor::run_condor_command(
+    std::string job_adaptor::submit(::condor::job::description const & desc,
+            std::string const & log, std::string & output,
+            std::size_t & processes) const
+    {
+        std::vector<std::string> args;
+        if (terse_submit_)
+            args.push_back("-terse");
+        args.push_back("-append");
+        args.push_back("log = " + log);
+        args.push_back("-append");
+        args.push_back("log_xml = True");
+        if (!listing_.session_tag.empty())
+        {
+            args.push_back("-append");
+            args.push_back("+SagaSession = "
+                + job_lister::quote(listing_.session_tag));
+        }
+
+        try
+        {
+            SAGA_VERBOSE(SAGA_VERBOSE_LEVEL_DEBUG)
+            {
+                std::ostringstream os;
+                os << " ** Condor adaptor (job::run)\n"
+                    "    About to submit job description:\n"
+                    "========================================\n"
+                    << desc
+                    << "========================================\n";
+
+                SAGA_LOG_DEBUG(os.str().c_str());
+            }
+
+            // Written straight to condor_submit, as it starts.
+            command_result result = run_condor_command("condor_submit", args,
+                boost::bind(&write_description, boost::cref(desc), _1));
+
+            std::istringstream out(result.output);
+            for (std::string line; getline(out, line); output += "\n  " + line)
+                /* Nothing to do */;
+
+            if (!result.succeeded())
+                SAGA_ADAPTOR_THROW_NO_CONTEXT("Failed to submit job to condor "
+                    "pool. Output from condor_submit follows:\n" + output,
+                    saga::NoSuccess);
+        }
+        catch (saga::adaptors::exception const &)
+        {
+            // Let our exceptions fall through.
+            throw;
+        }
+        catch (std::exception const & e)
+        {
+            SAGA_ADAPTOR_THROW_NO_CONTEXT("Problem launching condor job: "
+                "(std::exception caught: " + e.what() + ")",
+                saga::BadParameter);
+        }
+
+        return get_submitted_jobs(output, processes);
+    }
+
+    synchronized<job_registry>::lock job_adaptor::submit(pool & p,
+            ::condor::job::description const & desc,
+            std::string & cluster_id, std::string & output,
+            std::size_t * processes) const
+    {
+        std::size_t submitted = 0;
+
+        submit_governor & governor = p.get_submit_governor(*this);
+        std::string const log = p.get_log();
+
+        for (unsigned attempt = 0; ; ++attempt)
+        {
+            governor.wait_turn();
+
+            double const start = detail::now();
+
+            try
+            {
+                // Prevent processing of events, so we don't lose any...
+                synchronized<job_registry>::lock lck(p.get_registry());
+
+                output.clear();
+                cluster_id = submit(desc, log, output, submitted);
+                if (processes)
+                    *processes = submitted;
+
+                governor.succeeded(detail::now() - start);
+
+                return lck;
+            }
+            catch (saga::adaptors::exception const & e)
+            {
+                std::string const error = e.what();
+
+                double const delay = governor.failed(error, attempt);
+                if (delay < 0.)
+                    throw;
+
+                SAGA_LOG_WARN(("Condor adaptor: Submission to "
+                    + p.get_url() + " failed, retrying in "
+                    + boost::lexical_cast<std::string>(delay)
+                    + " seconds. " + error).c_str());
+            }
+        }
+    }
+
+    std::string job_adaptor::submit_dag(std::string const & dag_file,
+            std::string const & log, std::string & output) const
+    {
+        std::vector<std::string> args;
+        args.push_back("-force");
+        if (flow_control_.max_idle)
+        {
+            // DAGMan does its own throttling.
+            args.push_back("-maxidle");
+            args.push_back(
+                boost::lexical_cast<std::string>(flow_control_.max_idle));
+        }
+        args.push_back("-append");
+        args.push_back("log = " + log);
+        args.push_back("-append");
+        args.push_back("log_xml = True");
+        if (!listing_.session_tag.empty())
+        {
+            // Tags the DAGMan job, nodes are tagged in their descriptions.
+            args.push_back("-append");
+            args.push_back("+SagaSession = "
+                + job_lister::quote(listing_.session_tag));
+        }
+        args.push_back(dag_file);
+
+        try
+        {
+            SAGA_LOG_DEBUG((" ** Condor adaptor (job::run)\n"
+                "    About to submit DAG: " + dag_file).c_str());
+
+            command_result result
+                = run_condor_command("condor_submit_dag", args);
+
+            std::istringstream out(result.output);
+            for (std::string line; getline(out, line); output += "\n  " + line)
+                /* Nothing to do */;
+
+            if (!result.succeeded())
+                SAGA_ADAPTOR_THROW_NO_CONTEXT("Failed to submit DAG to condor "
+                    "pool. Output from condor_submit_dag follows:\n" + output,
+                    saga::NoSuccess);
+        }
+        catch (saga::adaptors::exception const &)
+        {
+            // Let our exceptions fall through.
+            throw;
+        }
+        catch (std::exception const & e)
+        {
+            SAGA_ADAPTOR_THROW_NO_CONTEXT("Problem launching condor DAG: "
+                "(std::exception caught: " + e.what() + ")",
+                saga::BadParameter);
+        }
+
+        return get_submitted_cluster(output);
+    }
+
+    command_result job_adaptor::run_condor_command(
             std::string const & command,
             std::vector<std::string> const & arguments,
-            boost::process::stream_behavior stdin_behavior,
-            boost::process::stream_behavior stdout_behavior,
-            boost::process::stream_behavior stderr_behavior) const
+            command_scheduler::producer const & produce) const
     {
         BOOST_ASSERT(initialized_);
 
-        boost::process::command_line cl(command, "", get_binary_path());
+        return cmd_scheduler_->run(command, arguments, produce);
+    }
 
-        std::vector<std::string>::const_iterator end = arguments.end();
-        for (std::vector<std::string>::const_iterator it = arguments.begin(); 
-             it != end; ++it)
-        {
-            cl.argument(*it);
-        }
+    command_result job_adaptor::run_condor_query(
+            std::string const & command,
+            std::vector<std::string> const & arguments) const
+    {
+        BOOST_ASSERT(initialized_);
+
+        return cmd_scheduler_->query(command, arguments);
+    }
+
+    void job_adaptor::fetch_queue(classad_reader::callback const & f) const
+    {
+        BOOST_ASSERT(initialized_);
 
-        boost::process::launcher l = cmd_launcher_;
-        l.set_stdin_behavior(stdin_behavior);
-        l.set_stdout_behavior(stdout_behavior);
-        l.set_stderr_behavior(stderr_behavior);
+        // Whole queues can be large, ClassAds are handed on as they are
+        // read, rather than collecting the output first.
+        classad_reader reader;
+        cmd_scheduler_->stream("condor_q", std::vector<std::string>(1, "-xml"),
+            boost::bind(&classad_reader::read, &reader, _1, boost::cref(f)));
+    }
+
+    void job_adaptor::fetch_history(std::vector<std::string> const & arguments,
+            classad_reader::callback const & f) const
+    {
+        BOOST_ASSERT(initialized_);
 
-        if (boost::process::close_stream != stdout_behavior
-                && boost::process::close_stream == stderr_behavior)
-            l.set_merge_out_err(true);
+        std::vector<std::string> args(1, "-xml");
+        args.insert(args.end(), arguments.begin(), arguments.end());
 
-        return l.start(cl);
+        // As above, the history file may be large.
+        classad_reader reader;
+        cmd_scheduler_->stream("condor_history", args,
+            boost::bind(&classad_reader::read, &reader, _1, boost::cref(f)));
+    }
+
+    void job_adaptor::list_jobs(job_lister::page_callback const & f) const
+    {
+        BOOST_ASSERT(initialized_);
+
+        job_lister lister(listing_);
+        cmd_scheduler_->stream("condor_q", lister.get_arguments(),
+            boost::bind(&job_lister::read, &lister, _1, boost::cref(f)));
     }
 
     boost::shared_ptr<shared_job_data>
@@ -155,4 +594,55 @@ namespace saga { namespace adaptors { namespace condor {
         return job;
     }
 
+    void job_adaptor::get_job_states(std::string const & rm,
+            std::vector<job_summary> & out,
+            std::set<std::string> const & job_ids,
+            std::set<saga::job::state> const & states) const
+    {
+        std::vector<shared_pool> candidate_pools;
+        {
+            // pools_ is guarded by the CPI mutex.
+            scoped_lock lck(const_cast<job_adaptor &>(*this));
+
+            pool_map::const_iterator end = pools_.end();
+            for (pool_map::const_iterator it = pools_.begin(); it != end; ++it)
+            {
+                if ((*it).second && (*it).second->get_url() == rm)
+                    candidate_pools.push_back((*it).second);
+            }
+        }
+
+        // One registry lock per pool.
+        std::vector<shared_pool>::iterator end = candidate_pools.end();
+        for (std::vector<shared_pool>::iterator it = candidate_pools.begin();
+             it != end; ++it)
+            (*it)->get_registry()->snapshot(out, job_ids, states);
+    }
+
+    job_footprint job_adaptor::get_job_footprint() const
+    {
+        std::vector<shared_pool> all_pools;
+        {
+            // pools_ is guarded by the CPI mutex.
+            scoped_lock lck(const_cast<job_adaptor &>(*this));
+
+            pool_map::const_iterator end = pools_.end();
+            for (pool_map::const_iterator it = pools_.begin(); it != end; ++it)
+            {
+                if ((*it).second)
+                    all_pools.push_back((*it).second);
+            }
+        }
+
+        job_footprint footprint;
+        footprint.live = shared_job_data::get_live_count();
+
+        std::vector<shared_pool>::iterator end = all_pools.end();
+        for (std::vector<shared_pool>::iterator it = all_pools.begin();
+             it != end; ++it)
+            (*it)->get_registry()->add_footprint(footprint);
+
+        return footprint;
+    }
+
 }}} // namespace saga::adaptors::condor
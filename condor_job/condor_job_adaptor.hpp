@@ -6,18 +6,38 @@
 #ifndef SAGA_ADAPTORS_CONDOR_JOB_CONDOR_JOB_ADAPTOR_HPP
 #define SAGA_ADAPTORS_CONDOR_JOB_CONDOR_JOB_ADAPTOR_HPP
 
+#include "admission_controller.hpp"
+#include "command_batcher.hpp"
+#include "command_scheduler.hpp"
+#include "completion_queue.hpp"
 #include "helper.hpp"
+#include "history_cache.hpp"
+#include "job_lister.hpp"
 #include "pool_data.hpp"
+#include "process.hpp"
+#include "queue_cache.hpp"
 #include "shared_job_data.hpp"
+#include "status_poller.hpp"
+#include "submit_governor.hpp"
+#include "task_bundler.hpp"
 
 #include <saga/saga/adaptors/adaptor.hpp>
 #include <saga/saga/adaptors/utils/is_local_address.hpp>
 
 #include <boost/assert.hpp>
-#include <boost/process.hpp>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include <map>
 #include <memory>
+#include <set>
+#include <vector>
+
+namespace condor { namespace job {
+
+    struct description;
+
+}} // namespace condor::job
 
 namespace saga { namespace adaptors { namespace condor {
 
@@ -58,6 +78,7 @@ namespace saga { namespace adaptors { namespace condor {
     public:
         job_adaptor()
             : initialized_(false)
+            , terse_submit_(true)
         {
         }
 
@@ -74,15 +95,83 @@ namespace saga { namespace adaptors { namespace condor {
             return default_section_;
         }
 
-        boost::process::child run_condor_command(std::string const & command,
+        task_bundler::config const & get_bundling_config() const
+        {
+            BOOST_ASSERT(initialized_);
+            return bundling_;
+        }
+
+        admission_controller::config const & get_flow_control_config() const
+        {
+            BOOST_ASSERT(initialized_);
+            return flow_control_;
+        }
+
+        command_batcher::config const & get_batching_config() const
+        {
+            BOOST_ASSERT(initialized_);
+            return batching_;
+        }
+
+        submit_governor::config const & get_submit_control_config() const
+        {
+            BOOST_ASSERT(initialized_);
+            return submit_control_;
+        }
+
+        job_lister::config const & get_listing_config() const
+        {
+            BOOST_ASSERT(initialized_);
+            return listing_;
+        }
+
+        status_poller::config const & get_polling_config() const
+        {
+            BOOST_ASSERT(initialized_);
+            return polling_;
+        }
+
+        //  Submits desc through condor_submit, with job events logged to log.
+        //  Returns the Cluster ID, or an empty string if it couldn't be
+        //  determined from the output of condor_submit, which is returned in
+        //  output. The number of processes submitted is returned in
+        //  processes, 0 if unknown. Throws if submission fails.
+        std::string submit(::condor::job::description const & desc,
+            std::string const & log, std::string & output,
+            std::size_t & processes) const;
+
+        //  Submits desc to pool p, as above, paced and retried by the pool's
+        //  submit_governor. On success, returns holding the lock on p's
+        //  registry, for the caller to register the job before its events
+        //  are processed.
+        synchronized<job_registry>::lock submit(pool & p,
+            ::condor::job::description const & desc,
+            std::string & cluster_id, std::string & output,
+            std::size_t * processes = 0) const;
+
+        //  Submits a DAG through condor_submit_dag, with events of the DAGMan
+        //  job logged to log. Returns the DAGMan job's Cluster ID, as above.
+        std::string submit_dag(std::string const & dag_file,
+            std::string const & log, std::string & output) const;
+
+        //  Runs a Condor command, with input written by produce, through
+        //  the adaptor's command_scheduler: concurrent invocations are capped
+        //  and stuck commands are killed. Throws std::runtime_error if the
+        //  command can't be run to completion.
+        command_result run_condor_command(std::string const & command,
             std::vector<std::string> const & arguments
                 = std::vector<std::string>(),
-            boost::process::stream_behavior stdin_behavior
-                = boost::process::redirect_stream,
-            boost::process::stream_behavior stdout_behavior
-                = boost::process::redirect_stream,
-            boost::process::stream_behavior stderr_behavior
-                = boost::process::close_stream) const;
+            command_scheduler::producer const & produce
+                = command_scheduler::producer()) const;
+
+        //  As above, for commands with no side effects (condor_q). Identical
+        //  queries in flight are run once.
+        command_result run_condor_query(std::string const & command,
+            std::vector<std::string> const & arguments) const;
+
+        //  Lists jobs in the queue, filtered as configured, handing pages of
+        //  job IDs to f as condor_q's output is read. See job_lister.
+        void list_jobs(job_lister::page_callback const & f) const;
 
         std::string validate_rm(saga::url url) const
         {
@@ -139,7 +228,7 @@ namespace saga { namespace adaptors { namespace condor {
 
             shared_pool & sp = pools_[rm];
             if (!sp)
-                sp.reset(new pool(rm, condor_log_));
+                sp.reset(new pool(rm, condor_log_, queue_cache_for(rm)));
             return sp;
         }
 
@@ -151,28 +240,108 @@ namespace saga { namespace adaptors { namespace condor {
 
             shared_pool & sp = pools_[log];
             if (!sp)
-                sp.reset(new pool(rm, log));
+                sp.reset(new pool(rm, log, queue_cache_for(rm)));
             return sp;
         }
 
+        //  Snapshot of the job queue on rm, for reconnecting to and listing
+        //  jobs.
+        boost::shared_ptr<queue_cache> get_queue_cache(std::string rm)
+        {
+            rm = validate_rm(rm);
+
+            scoped_lock lck(*this);
+            return queue_cache_for(rm);
+        }
+
+        //  Finished jobs on rm, for reconnecting to jobs that left the
+        //  queue.
+        boost::shared_ptr<history_cache> get_history_cache(std::string rm)
+        {
+            rm = validate_rm(rm);
+
+            scoped_lock lck(*this);
+
+            boost::shared_ptr<history_cache> & cache = history_caches_[rm];
+            if (!cache)
+                cache.reset(new history_cache(
+                    boost::bind(&job_adaptor::fetch_history, this, _1, _2),
+                    history_caching_));
+            return cache;
+        }
+
+        //  Jobs submitted to rm through this adaptor, reported as they
+        //  finish from the time of the first call. Valid for the life of the
+        //  adaptor.
+        completion_queue & get_completion_queue(std::string rm)
+        {
+            return get_pool(rm)->get_completion_queue();
+        }
+
         boost::shared_ptr<shared_job_data>
         find_job(std::string const & rm, std::string const & job_id) const;
 
+        //  States of the jobs tracked on rm, optionally restricted to the
+        //  given job IDs and states, from the registries of its pools. See
+        //  job_registry::snapshot.
+        void get_job_states(std::string const & rm,
+            std::vector<job_summary> & out,
+            std::set<std::string> const & job_ids = std::set<std::string>(),
+            std::set<saga::job::state> const & states
+                = std::set<saga::job::state>()) const;
+
+        //  Jobs alive and tracked on all pools, and the bytes tracked jobs
+        //  hold. See job_registry::add_footprint.
+        job_footprint get_job_footprint() const;
+
     private:
+        // Called with the CPI mutex held.
+        boost::shared_ptr<queue_cache> queue_cache_for(std::string const & rm)
+        {
+            boost::shared_ptr<queue_cache> & cache = queue_caches_[rm];
+            if (!cache)
+                cache.reset(new queue_cache(
+                    boost::bind(&job_adaptor::fetch_queue, this, _1),
+                    queue_caching_));
+            return cache;
+        }
+
+        // Reads ClassAds of all jobs from condor_q -xml.
+        void fetch_queue(classad_reader::callback const & f) const;
+
+        // Reads ClassAds from condor_history -xml.
+        void fetch_history(std::vector<std::string> const & arguments,
+            classad_reader::callback const & f) const;
+
         volatile bool initialized_; // controls access to immutable data
 
         // --- Begin Immutable data --- //
         std::string default_rm_;
         std::string binary_path_;
         std::string condor_log_;
+        bool terse_submit_;
         std::map<std::string, std::string> default_section_;
-
-        boost::process::launcher cmd_launcher_;
+        task_bundler::config bundling_;
+        admission_controller::config flow_control_;
+        submit_governor::config submit_control_;
+        command_batcher::config batching_;
+        command_scheduler::config command_control_;
+        queue_cache::config queue_caching_;
+        history_cache::config history_caching_;
+        job_lister::config listing_;
+        status_poller::config polling_;
+
+        process_launcher cmd_launcher_;
+        boost::scoped_ptr<command_scheduler> cmd_scheduler_;
         // --- End Immutable data --- //
 
         // --- Access controlled by CPI mutex --- //
         typedef std::map<std::string, shared_pool> pool_map;
         pool_map pools_;
+
+        std::map<std::string, boost::shared_ptr<queue_cache> > queue_caches_;
+        std::map<std::string, boost::shared_ptr<history_cache> >
+            history_caches_;
     };
 
 }}} // namespace saga::adaptors::condor
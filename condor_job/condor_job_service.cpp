@@ -10,9 +10,7 @@
 #include <saga/saga/adaptors/attribute.hpp>
 #include <saga/saga/packages/job/adaptors/job.hpp>
 
-#include <boost/regex.hpp>
-
-#include <set>
+#include <boost/bind.hpp>
 
 namespace saga { namespace adaptors { namespace condor {
 
@@ -133,45 +131,25 @@ namespace saga { namespace adaptors { namespace condor {
         ret = job;
     }
 
+    namespace {
+
+        // Appends a page of job IDs, as SAGA job IDs on rm.
+        void append_job_ids(std::vector<std::string> & job_ids,
+            std::string const & rm, std::vector<std::string> const & page)
+        {
+            for (std::size_t i = 0; i < page.size(); ++i)
+                job_ids.push_back("[" + rm + "]-[" + page[i] + "]");
+        }
+
+    } // namespace
+
     void job_service_cpi_impl::sync_list(std::vector<std::string> & list_of_jobids)
     {
         try
         {
-            std::vector<std::string> args;
-            args.push_back("-format");
-            args.push_back("%d.");
-            args.push_back("ClusterId");
-            args.push_back("-format");
-            args.push_back("%d\\n");
-            args.push_back("ProcId");
-
             // Might also want to get recent history, with condor_history, no?
-            boost::process::child c =
-                get_adaptor()->run_condor_command("condor_q", args,
-                    boost::process::close_stream);
-
-            boost::process::pistream & out = c.get_stdout();
-
-            std::set<std::string> clusters;
-            std::string process;
-            while (getline(out, process))
-            {
-                static const boost::regex re("(\\d+)\\.\\d+");
-                boost::smatch match;
-
-                if (boost::regex_match(process, match, re))
-                {
-                    std::string cluster = match.str(1);
-                    if (clusters.insert(cluster).second)
-                        list_of_jobids.push_back(
-                            "[" + condor_url_ + "]-[" + cluster + "]");
-
-                    list_of_jobids.push_back(
-                        "[" + condor_url_ + "]-[" + process + "]");
-                }
-            }
-
-            boost::process::status status = c.wait();
+            get_adaptor()->list_jobs(boost::bind(&append_job_ids,
+                boost::ref(list_of_jobids), boost::cref(condor_url_), _1));
         }
         catch (std::exception const & e)
         {
@@ -38,6 +38,23 @@ namespace saga { namespace adaptors { namespace condor {
 
         void sync_list(std::vector<std::string> & list_of_jobids);
 
+        // Not part of the CPI. States of the jobs the adaptor tracks on this
+        // service's URL, without invoking Condor commands.
+        void get_job_states(std::vector<job_summary> & out,
+            std::set<std::string> const & job_ids = std::set<std::string>(),
+            std::set<saga::job::state> const & states
+                = std::set<saga::job::state>()) const
+        {
+            get_adaptor()->get_job_states(condor_url_, out, job_ids, states);
+        }
+
+        // Not part of the CPI. Jobs submitted through services on this
+        // service's URL, reported as they finish. See completion_queue.
+        completion_queue & get_completion_queue()
+        {
+            return get_adaptor()->get_completion_queue(condor_url_);
+        }
+
         // WONTFIX: In general, there should be no way to manage a Condor job as
         //          one (using Condor interfaces) from inside the job.
         //
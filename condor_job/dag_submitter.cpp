@@ -0,0 +1,284 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "dag_submitter.hpp"
+#include "condor_job_adaptor.hpp"
+#include "log_processor.hpp"
+#include "pool_data.hpp"
+#include "shared_job_data.hpp"
+#include "temporary.hpp"
+
+#include <boost/lexical_cast.hpp>
+
+#include <sstream>
+
+#include <unistd.h>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    namespace {
+
+        // Files generated by condor_submit_dag and DAGMan, next to the DAG
+        // file.
+        char const * const dagman_files[] = {
+                ".condor.sub",
+                ".dagman.out",
+                ".dagman.log",
+                ".lib.out",
+                ".lib.err",
+                ".nodes.log",
+                ".metrics"
+            };
+
+        std::string get_scalar(saga::job::description const & jd,
+                char const * attribute)
+        {
+            if (!jd.attribute_exists(attribute))
+                SAGA_ADAPTOR_THROW_NO_CONTEXT("Missing attribute for DAG "
+                    "node: " + std::string(attribute) + ".",
+                    saga::BadParameter);
+
+            return jd.get_attribute(attribute);
+        }
+
+    } // namespace
+
+    dag_workflow::dag_workflow() {}
+
+    dag_workflow::~dag_workflow()
+    {
+        if (dag_file.empty())
+            return;
+
+        for (std::size_t i = 0;
+                i < sizeof(dagman_files) / sizeof(*dagman_files); ++i)
+            ::unlink((dag_file + dagman_files[i]).c_str());
+    }
+
+    dag_submitter::dag_submitter(job_adaptor const & adaptor, pool & p)
+        : adaptor_(adaptor)
+        , pool_(p)
+        , dag_count_(0)
+    {
+    }
+
+    bool dag_submitter::is_dag_node(saga::job::description const & jd)
+    {
+        return jd.attribute_exists(detail::description_dag_name);
+    }
+
+    dag_submitter::node dag_submitter::make_node(
+            saga::job::description const & jd,
+            boost::shared_ptr<shared_job_data> job)
+    {
+        using namespace detail;
+
+        node n;
+        n.dag = get_scalar(jd, description_dag_name);
+        n.name = get_scalar(jd, description_dag_node);
+
+        if (n.dag.empty())
+            SAGA_ADAPTOR_THROW_NO_CONTEXT("Empty "
+                + std::string(description_dag_name) + ".",
+                saga::BadParameter);
+
+        if (!is_valid_node_name(n.name))
+            SAGA_ADAPTOR_THROW_NO_CONTEXT("Invalid DAG node name: '"
+                + n.name + "'.", saga::BadParameter);
+
+        {
+            std::string value = get_scalar(jd, description_dag_size);
+
+            n.dag_size = 0;
+            try
+            {
+                n.dag_size = boost::lexical_cast<std::size_t>(value);
+            }
+            catch (boost::bad_lexical_cast const &)
+            {
+            }
+
+            if (!n.dag_size)
+                SAGA_ADAPTOR_THROW_NO_CONTEXT("Invalid value for "
+                    + std::string(description_dag_size) + ": '" + value
+                    + "' (expected a positive integer).", saga::BadParameter);
+        }
+
+        if (jd.attribute_exists(description_dag_parents))
+            n.parents = jd.get_vector_attribute(description_dag_parents);
+
+        {
+            std::vector<std::string>::const_iterator end = n.parents.end();
+            for (std::vector<std::string>::const_iterator it
+                    = n.parents.begin(); it != end; ++it)
+            {
+                if (!is_valid_node_name(*it))
+                    SAGA_ADAPTOR_THROW_NO_CONTEXT("Invalid DAG node name: '"
+                        + *it + "' (parent of node '" + n.name + "').",
+                        saga::BadParameter);
+            }
+        }
+
+        if (jd.attribute_exists(description_dag_post_script))
+            n.post_script
+                = jd.get_vector_attribute(description_dag_post_script);
+
+        n.job = job;
+        return n;
+    }
+
+    void dag_submitter::add(::condor::job::description const & desc,
+            node const & n)
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+
+        shared_dag & slot = pending_[n.dag];
+        if (!slot)
+        {
+            slot.reset(new pending_dag());
+            slot->tag = "SAGA" + boost::lexical_cast<std::string>(::getpid())
+                + "_" + boost::lexical_cast<std::string>(++dag_count_);
+            slot->size = n.dag_size;
+        }
+
+        shared_dag d = slot;
+
+        if (n.dag_size != d->size)
+            SAGA_ADAPTOR_THROW_NO_CONTEXT("Conflicting sizes given for DAG '"
+                + n.dag + "': " + boost::lexical_cast<std::string>(n.dag_size)
+                + " (node '" + n.name + "'), "
+                + boost::lexical_cast<std::string>(d->size) + " (earlier "
+                "nodes).", saga::BadParameter);
+
+        if (!d->names.insert(n.name).second)
+            SAGA_ADAPTOR_THROW_NO_CONTEXT("Duplicate node '" + n.name
+                + "' in DAG '" + n.dag + "'.", saga::BadParameter);
+
+        std::string const key = get_node_key(d->tag, n.name);
+
+        {
+            synchronized<job_registry>::lock lck(pool_.get_registry());
+            shared_job_data::scoped_lock job_lock(n.job->state_change_mtx);
+
+            n.job->state = saga::job::Running;
+            n.job->dag_post_script = !n.post_script.empty();
+            if (desc.get_process_count() > 1)
+                n.job->procs.resize(desc.get_process_count());
+
+            // No Cluster ID until DAGMan submits the node.
+            n.job->full_job_id = "[" + pool_.get_url() + "]-[" + key + "]";
+
+            lck->register_job(key, n.job);
+        }
+
+        d->descriptions.push_back(desc);
+        d->nodes.push_back(n);
+
+        if (d->nodes.size() < d->size)
+            return;
+
+        // Complete.
+        pending_.erase(n.dag);
+        lock.unlock();
+
+        try
+        {
+            submit_dag(*d);
+        }
+        catch (...)
+        {
+            fail_dag(*d);
+            throw;
+        }
+    }
+
+    void dag_submitter::submit_dag(pending_dag & d)
+    {
+        boost::shared_ptr<dag_workflow> workflow(new dag_workflow());
+
+        std::string const log = pool_.get_log();
+        std::vector<std::string> submit_files;
+
+        for (std::size_t i = 0; i < d.nodes.size(); ++i)
+        {
+            node const & n = d.nodes[i];
+
+            // Node jobs report to the pool's log, along with regular jobs.
+            ::condor::job::description desc = d.descriptions[i];
+            desc.set_attribute("log", log);
+            desc.set_attribute("log_xml", "True");
+
+            std::string const & session_tag
+                = adaptor_.get_listing_config().session_tag;
+            if (!session_tag.empty())
+                desc.set_attribute("+SagaSession",
+                    job_lister::quote(session_tag));
+
+            std::stringstream submit;
+            submit << desc;
+
+            boost::shared_ptr<temporary_file> file(
+                open_temporary_file("saga-condor-node").release());
+            if (!file || !write_temporary_file(*file, submit.str()))
+                SAGA_ADAPTOR_THROW_NO_CONTEXT("Failed to write submit "
+                    "description for DAG node '" + n.name + "'.",
+                    saga::NoSuccess);
+
+            workflow->files.push_back(file);
+            submit_files.push_back(file->get_path().string());
+        }
+
+        std::string const dag = make_dag(d.tag, d.nodes, submit_files);
+
+        boost::shared_ptr<temporary_file> dag_file(
+            open_temporary_file("saga-condor-dag").release());
+        if (!dag_file || !write_temporary_file(*dag_file, dag))
+            SAGA_ADAPTOR_THROW_NO_CONTEXT("Failed to write DAG file for DAG '"
+                + d.nodes.front().dag + "'.", saga::NoSuccess);
+
+        workflow->files.push_back(dag_file);
+
+        std::string output;
+
+        // Prevent processing of events, so we don't lose any...
+        synchronized<job_registry>::lock lck(pool_.get_registry());
+
+        std::string const cluster_id
+            = adaptor_.submit_dag(dag_file->get_path().string(), log, output);
+        workflow->dag_file = dag_file->get_path().string();
+
+        if (cluster_id.empty())
+            SAGA_ADAPTOR_THROW_NO_CONTEXT("Failed to determine Cluster ID of "
+                "DAGMan job from the output of condor_submit_dag (see "
+                "below). Won't be able to track DAG '" + d.nodes.front().dag
+                + "'.\n" + output, saga::NoSuccess);
+
+        boost::shared_ptr<shared_job_data> dagman_job(new shared_job_data());
+        dagman_job->pool_ = d.nodes.front().job->pool_;
+        dagman_job->state = saga::job::Running;
+        dagman_job->cluster_id = cluster_id;
+        dagman_job->full_job_id = "[" + pool_.get_url() + "]-["
+            + cluster_id + "]";
+
+        for (std::size_t i = 0; i < d.nodes.size(); ++i)
+            workflow->nodes.push_back(d.nodes[i].job);
+
+        dagman_job->dag = workflow;
+        lck->register_job(dagman_job);
+    }
+
+    void dag_submitter::fail_dag(pending_dag & d)
+    {
+        for (std::size_t i = 0; i < d.nodes.size(); ++i)
+        {
+            shared_job_data & job = *d.nodes[i].job;
+            shared_job_data::scoped_lock lock(job.state_change_mtx);
+
+            job.state = saga::job::Failed;
+            log_processor::notify(job, -1);
+        }
+    }
+
+}}} // namespace saga::adaptors::condor
@@ -0,0 +1,209 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_DAG_SUBMITTER_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_DAG_SUBMITTER_HPP
+
+#include "description.hpp"
+
+#include <saga/saga/packages/job/job_description.hpp>
+
+#include <saga/saga-defs.hpp>
+#include <saga/impl/exception.hpp>
+
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/assert.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    class job_adaptor;
+    struct pool;
+    struct shared_job_data;
+    struct temporary_file;
+
+    //  A DAG submitted to DAGMan. Attached to the shared_job_data of the
+    //  DAGMan job, for the log processor to settle nodes DAGMan never got
+    //  to run once the DAGMan job terminates.
+    struct dag_workflow
+    {
+        dag_workflow();
+
+        // Removes the DAG file and files generated from it by DAGMan.
+        ~dag_workflow();
+
+        std::vector<boost::shared_ptr<shared_job_data> > nodes;
+
+        std::string dag_file;
+        std::vector<boost::shared_ptr<temporary_file> > files;
+    };
+
+    //  Collects SAGA jobs making up a DAG and submits them as a whole through
+    //  condor_submit_dag, leaving DAGMan to pipeline the stages of the
+    //  workflow on the schedd.
+    //
+    //  Nodes are tagged by the Condor-specific CondorDag* extensions to the
+    //  job description. The DAG is submitted once all of its nodes (as given
+    //  by CondorDagSize) have been run. Until then, and until DAGMan submits
+    //  them, nodes are Running with no Cluster ID.
+    //
+    //  Node jobs log to the pool's log. The log processor associates them
+    //  with their SAGA jobs through the "DAG Node: <name>" notes DAGMan adds
+    //  to the submit event. Node names are prefixed with a tag unique to the
+    //  DAG, and the prefixed name is used as job ID for the node.
+    struct dag_submitter
+    {
+        struct node
+        {
+            std::string dag;
+            std::string name;
+            std::vector<std::string> parents;
+            std::vector<std::string> post_script;
+            std::size_t dag_size;
+
+            boost::shared_ptr<shared_job_data> job;
+        };
+
+        dag_submitter(job_adaptor const & adaptor, pool & p);
+
+        static bool is_dag_node(saga::job::description const & jd);
+
+        //  Throws BadParameter on missing or ill-formed CondorDag*
+        //  attributes.
+        static node make_node(saga::job::description const & jd,
+            boost::shared_ptr<shared_job_data> job);
+
+        // Node names are alphanumeric, with '_' and '-'.
+        static bool is_valid_node_name(std::string const & name)
+        {
+            return !name.empty()
+                && boost::all(name,
+                    boost::is_alnum() || boost::is_any_of("_-"));
+        }
+
+        //  Name of node in the DAG file, and its job ID until DAGMan submits
+        //  it. tag is unique to the DAG.
+        static std::string get_node_key(std::string const & tag,
+            std::string const & name)
+        {
+            return tag + "_" + name;
+        }
+
+        //  Generates the DAG file for nodes, tagged with tag, with
+        //  submit_files[i] holding the submit description of nodes[i].
+        //  Throws BadParameter if a parent isn't one of nodes.
+        static std::string make_dag(std::string const & tag,
+            std::vector<node> const & nodes,
+            std::vector<std::string> const & submit_files);
+
+        //  Adds node to its DAG, setting up the node's job data. Submits the
+        //  DAG, once complete. Throws if the DAG is inconsistent or couldn't
+        //  be submitted, in which case any other nodes of the DAG are marked
+        //  Failed.
+        void add(::condor::job::description const & desc, node const & n);
+
+    private:
+        // Quotes str for the DAG file, if needed.
+        static std::string quote(std::string const & str)
+        {
+            if (std::string::npos == str.find_first_of(" \t\""))
+                return str;
+
+            return "\"" + str + "\"";
+        }
+
+        struct pending_dag
+        {
+            std::string tag;
+            std::size_t size;
+
+            std::vector< ::condor::job::description> descriptions;
+            std::vector<node> nodes;
+            std::set<std::string> names;
+        };
+
+        typedef boost::shared_ptr<pending_dag> shared_dag;
+        typedef std::map<std::string, shared_dag> dag_map;
+
+        void submit_dag(pending_dag & d);
+        void fail_dag(pending_dag & d);
+
+        job_adaptor const & adaptor_;
+        pool & pool_;
+
+        boost::mutex mtx_;
+        dag_map pending_;
+        unsigned long dag_count_;
+    };
+
+    inline std::string dag_submitter::make_dag(std::string const & tag,
+            std::vector<node> const & nodes,
+            std::vector<std::string> const & submit_files)
+    {
+        BOOST_ASSERT(!nodes.empty() && nodes.size() == submit_files.size());
+
+        std::set<std::string> names;
+        for (std::size_t i = 0; i < nodes.size(); ++i)
+            names.insert(nodes[i].name);
+
+        std::string dag =
+            "# Generated by the SAGA Condor adaptor, for DAG "
+            + nodes.front().dag + ".\n";
+        std::string dependencies;
+
+        for (std::size_t i = 0; i < nodes.size(); ++i)
+        {
+            node const & n = nodes[i];
+            std::string const key = get_node_key(tag, n.name);
+
+            dag += "JOB " + key + " " + submit_files[i] + "\n";
+
+            if (!n.post_script.empty())
+            {
+                dag += "SCRIPT POST " + key;
+
+                std::vector<std::string>::const_iterator end
+                    = n.post_script.end();
+                for (std::vector<std::string>::const_iterator it
+                        = n.post_script.begin(); it != end; ++it)
+                    dag += " " + quote(*it);
+
+                dag += "\n";
+            }
+
+            if (!n.parents.empty())
+            {
+                dependencies += "PARENT";
+
+                std::vector<std::string>::const_iterator end
+                    = n.parents.end();
+                for (std::vector<std::string>::const_iterator it
+                        = n.parents.begin(); it != end; ++it)
+                {
+                    if (!names.count(*it))
+                        SAGA_ADAPTOR_THROW_NO_CONTEXT("Unknown parent '"
+                            + *it + "' for node '" + n.name + "' in DAG '"
+                            + n.dag + "'.", saga::BadParameter);
+
+                    dependencies += " " + get_node_key(tag, *it);
+                }
+
+                dependencies += " CHILD " + key + "\n";
+            }
+        }
+
+        return dag + dependencies;
+    }
+
+}}} // namespace saga::adaptors::condor
+
+#endif // include guard
@@ -16,6 +16,8 @@
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/lexical_cast.hpp>
 
 
 // Boost.Filesystem
@@ -23,6 +25,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 namespace condor { namespace job {
 
@@ -40,11 +43,72 @@ namespace condor { namespace job {
         {
         }
 
+        attributes_type const & get_attributes() const
+        {
+            return attributes_;
+        }
+
+        void set_attribute(std::string const & key, std::string const & value)
+        {
+            attributes_[key] = value;
+        }
+
+        //  Item data for parameter sweeps. When items are set, the
+        //  description is queued with a "queue <variables> from ( ... )"
+        //  statement, producing one process per item in a single cluster.
+        //  Each item is a line of Condor itemdata, i.e., values separated by
+        //  commas or whitespace, matched in order against the variables. With
+        //  no variables, each item is available to the description as
+        //  $(Item).
+        void set_queue_items(std::vector<std::string> const & variables,
+                std::vector<std::string> const & items)
+        {
+            queue_variables_ = variables;
+            queue_items_ = items;
+        }
+
+        std::vector<std::string> const & get_queue_items() const
+        {
+            return queue_items_;
+        }
+
+        // Number of processes the description is queued with.
+        std::size_t get_process_count() const
+        {
+            if (!queue_items_.empty())
+                return queue_items_.size();
+
+            attributes_type::const_iterator queue = attributes_.find("queue");
+            if (attributes_.end() == queue || queue->second.empty())
+                return 1;
+
+            try
+            {
+                return boost::lexical_cast<std::size_t>(queue->second);
+            }
+            catch (boost::bad_lexical_cast const &)
+            {
+                return 1;
+            }
+        }
+
+        //  Late materialization: the schedd keeps at most max_materialize
+        //  processes of the cluster materialized at any time, instead of
+        //  creating an ad for every process upfront.
+        void set_max_materialize(std::size_t max_materialize)
+        {
+            attributes_["max_materialize"]
+                = boost::lexical_cast<std::string>(max_materialize);
+        }
+
     protected:
         template <class Ostr>
         friend Ostr & operator<<(Ostr &, description const &);
 
         attributes_type attributes_;
+
+        std::vector<std::string> queue_variables_;
+        std::vector<std::string> queue_items_;
     };
 
     template <class Ostr>
@@ -65,7 +129,38 @@ namespace condor { namespace job {
                     content += (*it).first + " = " + (*it).second + "\n";
         }
 
-        ostr << (content + postlog);
+        if (desc.queue_items_.empty())
+        {
+            ostr << (content + postlog);
+            return ostr;
+        }
+
+        // Items are streamed out directly, sweeps may be large.
+        std::string variables;
+        {
+            std::vector<std::string>::const_iterator end
+                = desc.queue_variables_.end();
+            for (std::vector<std::string>::const_iterator it
+                    = desc.queue_variables_.begin(); it != end; ++it)
+            {
+                if (!variables.empty())
+                    variables += ",";
+                variables += *it;
+            }
+        }
+
+        ostr << content << "queue " << variables
+            << (variables.empty() ? "" : " ") << "from (\n";
+
+        std::vector<std::string>::const_iterator items_end
+            = desc.queue_items_.end();
+        for (std::vector<std::string>::const_iterator it
+                = desc.queue_items_.begin(); it != items_end; ++it)
+        {
+            ostr << *it << "\n";
+        }
+
+        ostr << ")\n";
 
         return ostr;
     }
@@ -74,6 +169,42 @@ namespace condor { namespace job {
 
 namespace saga { namespace adaptors { namespace condor { namespace detail {
 
+    //  Condor-specific extensions to the SAGA job description.
+    //
+    //  CondorQueueItems (vector): one line of itemdata per process, as in the
+    //      "queue ... from ( ... )" submit statement.
+    //  CondorQueueVariables (vector): names under which the fields of each
+    //      item are available to the description, e.g., as $(name) in
+    //      Arguments. Defaults to $(Item).
+    //  CondorMaxMaterialize (scalar): upper bound on the number of
+    //      processes of the cluster materialized by the schedd at any time.
+    char const * const description_queue_items = "CondorQueueItems";
+    char const * const description_queue_variables = "CondorQueueVariables";
+    char const * const description_max_materialize = "CondorMaxMaterialize";
+
+    //  CondorPriority (scalar): the job's priority, as in the Priority submit
+    //      command. Also orders jobs waiting for admission, see
+    //      admission_controller.
+    char const * const description_priority = "CondorPriority";
+
+    //  DAG nodes, see dag_submitter.
+    //
+    //  CondorDagName (scalar): identifies the DAG, among those run through
+    //      the same job service.
+    //  CondorDagNode (scalar): name of the node, unique in the DAG.
+    //  CondorDagSize (scalar): number of nodes in the DAG. The DAG is
+    //      submitted once this many nodes have been run.
+    //  CondorDagParents (vector): nodes that must complete successfully
+    //      before this one is started.
+    //  CondorDagPostScript (vector): script, and its arguments, run on the
+    //      submit machine after the node's job terminates. Its exit code
+    //      decides whether the node is Done or Failed.
+    char const * const description_dag_name = "CondorDagName";
+    char const * const description_dag_node = "CondorDagNode";
+    char const * const description_dag_size = "CondorDagSize";
+    char const * const description_dag_parents = "CondorDagParents";
+    char const * const description_dag_post_script = "CondorDagPostScript";
+
     struct saga_to_condor
         : ::condor::job::description
     {
@@ -121,6 +252,9 @@ namespace saga { namespace adaptors { namespace condor { namespace detail {
             map_attribute(description_job_start_time, "deferral_time");
 
             map_attribute(description_number_of_processes, "queue", "1");
+            map_attribute(description_priority, "priority");
+
+            process_queue_items();
 
             process_x509_certs();
             
@@ -295,6 +429,85 @@ namespace saga { namespace adaptors { namespace condor { namespace detail {
           return true;
         }
 
+
+        bool process_queue_items()
+        {
+            using namespace saga::job::attributes;
+
+            if (saga_description_.attribute_exists(description_max_materialize))
+            {
+                std::string value = saga_description_.get_attribute(
+                    description_max_materialize);
+
+                std::size_t max_materialize = 0;
+                try
+                {
+                    max_materialize = boost::lexical_cast<std::size_t>(value);
+                }
+                catch (boost::bad_lexical_cast const &)
+                {
+                }
+
+                if (!max_materialize)
+                    SAGA_ADAPTOR_THROW_NO_CONTEXT("Invalid value for "
+                        + std::string(description_max_materialize) + ": '"
+                        + value + "' (expected a positive integer).",
+                        saga::BadParameter);
+
+                set_max_materialize(max_materialize);
+            }
+
+            if (!saga_description_.attribute_exists(description_queue_items))
+                return false;
+
+            std::vector<std::string> const & items =
+                saga_description_.get_vector_attribute(description_queue_items);
+            if (items.empty())
+                return false;
+
+            if (saga_description_.attribute_exists(
+                        description_number_of_processes)
+                    && "1" != saga_description_.get_attribute(
+                        description_number_of_processes))
+                SAGA_ADAPTOR_THROW_NO_CONTEXT("NumberOfProcesses can't be "
+                    "combined with " + std::string(description_queue_items)
+                    + ", the number of processes is given by the number of "
+                    "items.", saga::BadParameter);
+
+            std::vector<std::string>::const_iterator end = items.end();
+            for (std::vector<std::string>::const_iterator it = items.begin();
+                 it != end; ++it)
+            {
+                // A line holding a closing parenthesis terminates itemdata.
+                if (boost::contains(*it, "\n")
+                        || ")" == boost::trim_copy(*it))
+                    SAGA_ADAPTOR_THROW_NO_CONTEXT("Invalid queue item: '"
+                        + *it + "'.", saga::BadParameter);
+            }
+
+            std::vector<std::string> variables;
+            if (saga_description_.attribute_exists(description_queue_variables))
+                variables = saga_description_.get_vector_attribute(
+                    description_queue_variables);
+
+            {
+                std::vector<std::string>::const_iterator end = variables.end();
+                for (std::vector<std::string>::const_iterator it
+                        = variables.begin(); it != end; ++it)
+                {
+                    if ((*it).empty() || !boost::all((*it),
+                            boost::is_alnum() || boost::is_any_of("_")))
+                        SAGA_ADAPTOR_THROW_NO_CONTEXT("Invalid queue "
+                            "variable name: '" + *it + "'.",
+                            saga::BadParameter);
+                }
+            }
+
+            attributes_.erase("queue");
+            set_queue_items(variables, items);
+
+            return true;
+        }
       
         bool process_file_transfer()
         {
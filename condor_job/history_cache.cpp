@@ -0,0 +1,272 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "history_cache.hpp"
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/regex.hpp>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    namespace {
+
+        bool is_number(std::string const & str)
+        {
+            return !str.empty()
+                && std::string::npos == str.find_first_not_of("0123456789");
+        }
+
+    } // namespace
+
+    history_cache::history_cache(fetch_function const & fetch,
+            config const & c)
+        : fetch_(fetch)
+        , config_(c)
+        , swept_(false)
+        , sweeping_(false)
+    {
+    }
+
+    bool history_cache::get_job(std::string const & job_id,
+            std::string & classads)
+    {
+        std::string::size_type const dot = job_id.find('.');
+        std::string const cluster_id = job_id.substr(0, dot);
+        std::string const proc = std::string::npos != dot
+            ? job_id.substr(dot + 1) : std::string();
+
+        // Job IDs end up in a constraint.
+        if (!is_number(cluster_id) || !(proc.empty() || is_number(proc)))
+            return false;
+
+        std::vector<std::string> args;
+        args.push_back("-constraint");
+        if (proc.empty())
+            args.push_back("ClusterId == " + cluster_id);
+        else
+        {
+            args.push_back("ClusterId == " + cluster_id
+                + " && ProcId == " + proc);
+            args.push_back("-match");
+            args.push_back("1");
+        }
+
+        if (!config_.capacity)
+        {
+            process_map processes;
+            fetch_(args, boost::bind(&history_cache::collect,
+                boost::ref(processes), boost::cref(cluster_id), _1));
+
+            return format(processes, proc, classads);
+        }
+
+        boost::mutex::scoped_lock lock(mtx_);
+
+        if (find(cluster_id, proc, classads))
+            return true;
+
+        sweep(lock);
+        if (find(cluster_id, proc, classads))
+            return true;
+
+        fetch(lock, args, proc.empty() ? cluster_id : std::string());
+        return find(cluster_id, proc, classads);
+    }
+
+    std::size_t history_cache::size() const
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+        return clusters_.size();
+    }
+
+    bool history_cache::find(std::string const & cluster_id,
+            std::string const & proc, std::string & classads)
+    {
+        cluster_map::iterator it = clusters_.find(cluster_id);
+        if (clusters_.end() == it
+                || (proc.empty() && !(*it).second.complete)
+                || !format((*it).second.processes, proc, classads))
+            return false;
+
+        lru_.splice(lru_.begin(), lru_, (*it).second.position);
+        return true;
+    }
+
+    void history_cache::sweep(boost::mutex::scoped_lock & lock)
+    {
+        if (swept_)
+            return;
+
+        if (sweeping_)
+        {
+            while (sweeping_)
+                swept_cond_.wait(lock);
+            return;
+        }
+
+        sweeping_ = true;
+
+        std::vector<std::string> args;
+        args.push_back("-match");
+        args.push_back(boost::lexical_cast<std::string>(config_.capacity));
+
+        try
+        {
+            fetch(lock, args);
+        }
+        catch (...)
+        {
+            // Next lookup tries again.
+            sweeping_ = false;
+            swept_cond_.notify_all();
+            throw;
+        }
+
+        swept_ = true;
+        sweeping_ = false;
+        swept_cond_.notify_all();
+    }
+
+    void history_cache::fetch(boost::mutex::scoped_lock & lock,
+            std::vector<std::string> const & arguments,
+            std::string const & cluster_id)
+    {
+        // Processes of a whole cluster are added together, so lookups
+        // meanwhile don't find part of it marked complete.
+        process_map processes;
+
+        lock.unlock();
+
+        try
+        {
+            if (cluster_id.empty())
+                fetch_(arguments, boost::bind(&history_cache::add, this, _1));
+            else
+                fetch_(arguments, boost::bind(&history_cache::collect,
+                    boost::ref(processes), boost::cref(cluster_id), _1));
+        }
+        catch (...)
+        {
+            lock.lock();
+            throw;
+        }
+
+        lock.lock();
+
+        if (cluster_id.empty() || processes.empty())
+            return;
+
+        cluster & c = insert(cluster_id);
+        c.processes.swap(processes);
+        c.complete = true;
+    }
+
+    void history_cache::add(std::string const & classad)
+    {
+        std::string cluster_id;
+        std::size_t proc;
+        if (!parse(classad, cluster_id, proc))
+            return;
+
+        boost::mutex::scoped_lock lock(mtx_);
+        insert(cluster_id).processes[proc] = classad;
+    }
+
+    history_cache::cluster & history_cache::insert(
+            std::string const & cluster_id)
+    {
+        cluster_map::iterator it = clusters_.find(cluster_id);
+        if (clusters_.end() == it)
+        {
+            it = clusters_.insert(
+                cluster_map::value_type(cluster_id, cluster())).first;
+            (*it).second.position = lru_.insert(lru_.begin(), cluster_id);
+
+            if (clusters_.size() > config_.capacity)
+            {
+                clusters_.erase(lru_.back());
+                lru_.pop_back();
+            }
+        }
+
+        return (*it).second;
+    }
+
+    bool history_cache::parse(std::string const & classad,
+            std::string & cluster_id, std::size_t & proc)
+    {
+        static boost::regex const cluster_re(
+            "<a\\s+n=\"ClusterId\">\\s*<i>(\\d+)</i>");
+        static boost::regex const proc_re(
+            "<a\\s+n=\"ProcId\">\\s*<i>(\\d+)</i>");
+
+        // Removed (3) or Completed (4)
+        static boost::regex const finished_re(
+            "<a\\s+n=\"JobStatus\">\\s*<i>[34]</i>");
+
+        boost::smatch cluster, process;
+        if (!boost::regex_search(classad, cluster, cluster_re)
+                || !boost::regex_search(classad, process, proc_re)
+                || !boost::regex_search(classad, finished_re))
+            return false;
+
+        try
+        {
+            proc = boost::lexical_cast<std::size_t>(process.str(1));
+        }
+        catch (boost::bad_lexical_cast const &)
+        {
+            return false;
+        }
+
+        cluster_id = cluster.str(1);
+        return true;
+    }
+
+    void history_cache::collect(process_map & processes,
+            std::string const & cluster_id, std::string const & classad)
+    {
+        std::string id;
+        std::size_t proc;
+        if (parse(classad, id, proc) && id == cluster_id)
+            processes[proc] = classad;
+    }
+
+    bool history_cache::format(process_map const & processes,
+            std::string const & proc, std::string & classads)
+    {
+        if (!proc.empty())
+        {
+            process_map::const_iterator it;
+            try
+            {
+                it = processes.find(boost::lexical_cast<std::size_t>(proc));
+            }
+            catch (boost::bad_lexical_cast const &)
+            {
+                return false;
+            }
+
+            if (processes.end() == it)
+                return false;
+
+            classads = (*it).second;
+            return true;
+        }
+
+        if (processes.empty())
+            return false;
+
+        classads.clear();
+        process_map::const_iterator end = processes.end();
+        for (process_map::const_iterator it = processes.begin(); it != end;
+                ++it)
+            classads += (*it).second + "\n";
+
+        return true;
+    }
+
+}}} // namespace saga::adaptors::condor
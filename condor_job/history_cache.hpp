@@ -0,0 +1,140 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_HISTORY_CACHE_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_HISTORY_CACHE_HPP
+
+#include "classad_reader.hpp"
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    //  ClassAds of finished jobs, from condor_history, for reconnecting to
+    //  jobs no longer in the queue.
+    //
+    //  The first lookup reads the ClassAds of the most recently finished
+    //  jobs, up to capacity, with a single condor_history. Lookups of jobs
+    //  not among those query condor_history for the job alone. Either way,
+    //  the ClassAds are kept, up to capacity clusters, least recently used
+    //  dropped first, so reconnecting to many finished jobs doesn't scan
+    //  the history once per job.
+    //
+    //  The first lookup's limit counts processes, so it may read part of
+    //  a cluster. Whole clusters are only served from clusters read with a
+    //  constraint on their ClusterId alone, others are read again.
+    //
+    //  Only ClassAds of removed and completed jobs are kept.
+    struct history_cache
+        : boost::noncopyable
+    {
+        struct config
+        {
+            config()
+                : capacity(1000)
+            {
+            }
+
+            // Clusters kept. 0 disables caching.
+            std::size_t capacity;
+        };
+
+        //  Runs condor_history -xml with the given arguments (e.g., a
+        //  constraint), handing each ClassAd to the callback, as it is read.
+        typedef boost::function<void(std::vector<std::string> const &,
+            classad_reader::callback const &)> fetch_function;
+
+        history_cache(fetch_function const & fetch,
+            config const & c = config());
+
+        //  ClassAds (as XML) of job_id: one for "Cluster.Proc", every
+        //  process' for "Cluster". Returns false if the job isn't in the
+        //  history. Throws what fetch throws.
+        bool get_job(std::string const & job_id, std::string & classads);
+
+        // Clusters currently kept.
+        std::size_t size() const;
+
+    private:
+        typedef std::map<std::size_t, std::string> process_map;
+        typedef std::list<std::string> lru_list;
+
+        struct cluster
+        {
+            cluster()
+                : complete(false)
+            {
+            }
+
+            process_map processes;
+            lru_list::iterator position;
+
+            // Read with a constraint on the ClusterId alone.
+            bool complete;
+        };
+
+        typedef std::map<std::string, cluster> cluster_map;
+
+        //  Looks a job up, marking its cluster as used. Whole clusters are
+        //  only found if complete. Called with the lock held.
+        bool find(std::string const & cluster_id, std::string const & proc,
+            std::string & classads);
+
+        // Reads recently finished jobs, once. Called with the lock held.
+        void sweep(boost::mutex::scoped_lock & lock);
+
+        //  Runs fetch, adding the ClassAds read. If arguments constrain the
+        //  ClusterId alone, cluster_id names that cluster, whose processes
+        //  read replace those kept and mark it complete. Called with the lock
+        //  held, which is released meanwhile.
+        void fetch(boost::mutex::scoped_lock & lock,
+            std::vector<std::string> const & arguments,
+            std::string const & cluster_id = std::string());
+
+        // Adds a job's ClassAd, if it is finished.
+        void add(std::string const & classad);
+
+        //  Cluster cluster_id, added if it isn't kept, dropping the least
+        //  recently used over capacity. Called with the lock held.
+        cluster & insert(std::string const & cluster_id);
+
+        //  Identifies a finished job's ClassAd. Returns false for ClassAds
+        //  of other jobs.
+        static bool parse(std::string const & classad,
+            std::string & cluster_id, std::size_t & proc);
+
+        // Adds a ClassAd of cluster_id to processes, if it is finished.
+        static void collect(process_map & processes,
+            std::string const & cluster_id, std::string const & classad);
+
+        //  Formats ClassAds of proc (all processes, if empty) as get_job
+        //  does.
+        static bool format(process_map const & processes,
+            std::string const & proc, std::string & classads);
+
+        fetch_function const fetch_;
+        config const config_;
+
+        mutable boost::mutex mtx_;
+        cluster_map clusters_;
+        lru_list lru_;      // Most recently used first
+
+        // One sweep at a time, and only one.
+        bool swept_;
+        bool sweeping_;
+        boost::condition swept_cond_;
+    };
+
+}}} // namespace saga::adaptors::condor
+
+#endif // include guard
@@ -0,0 +1,247 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_JOB_LISTER_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_JOB_LISTER_HPP
+
+#include <boost/function.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <istream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    //  Lists jobs in the queue with `condor_q -constraint ... -af ClusterId
+    //  ProcId`. Owner, session tag and state filters are evaluated by the
+    //  schedd, and only IDs come back, one job per line. Output is read as
+    //  condor_q writes it, and handed on in pages of job IDs.
+    struct job_lister
+    {
+        struct config
+        {
+            config()
+                : page_size(1000)
+                , processes(true)
+            {
+            }
+
+            // Only jobs of owner. Empty for all owners.
+            std::string owner;
+
+            //  Jobs submitted by the adaptor are tagged with this, as
+            //  SagaSession, and only jobs so tagged are listed. Empty for no
+            //  tag.
+            std::string session_tag;
+
+            // Only jobs with these JobStatus codes. Empty for all.
+            std::set<int> states;
+
+            // Job IDs per page. 0 for one per page.
+            std::size_t page_size;
+
+            // List "Cluster.Proc" IDs, besides "Cluster".
+            bool processes;
+        };
+
+        // Gets a page of job IDs, "Cluster" or "Cluster.Proc".
+        typedef boost::function<void(std::vector<std::string> const &)>
+            page_callback;
+
+        explicit job_lister(config const & c = config())
+            : config_(c)
+        {
+        }
+
+        //  JobStatus code of a Condor state name ("Idle", "Running",
+        //  "Removed", "Completed", "Held", "Transferring", "Suspended"), -1
+        //  if unknown.
+        static int get_state_code(std::string const & name)
+        {
+            static char const * const names[] = { "Idle", "Running",
+                "Removed", "Completed", "Held", "Transferring", "Suspended" };
+
+            for (std::size_t i = 0; i < sizeof(names) / sizeof(*names); ++i)
+                if (name == names[i])
+                    return int(i) + 1;
+            return -1;
+        }
+
+        //  ClassAd expression selecting the jobs to list, empty to list all
+        //  jobs.
+        std::string get_constraint() const
+        {
+            std::string constraint;
+
+            if (!config_.owner.empty())
+                append(constraint, "Owner == " + quote(config_.owner));
+
+            if (!config_.session_tag.empty())
+                append(constraint,
+                    "SagaSession == " + quote(config_.session_tag));
+
+            if (!config_.states.empty())
+            {
+                std::string states;
+                std::set<int>::const_iterator end = config_.states.end();
+                for (std::set<int>::const_iterator it = config_.states.begin();
+                        it != end; ++it)
+                {
+                    if (!states.empty())
+                        states += " || ";
+                    states += "JobStatus == "
+                        + boost::lexical_cast<std::string>(*it);
+                }
+                append(constraint, "(" + states + ")");
+            }
+
+            return constraint;
+        }
+
+        // Arguments to condor_q.
+        std::vector<std::string> get_arguments() const
+        {
+            std::vector<std::string> args;
+
+            std::string const constraint = get_constraint();
+            if (!constraint.empty())
+            {
+                args.push_back("-constraint");
+                args.push_back(constraint);
+            }
+
+            args.push_back("-af");
+            args.push_back("ClusterId");
+            args.push_back("ProcId");
+
+            return args;
+        }
+
+        //  Parses a "ClusterId ProcId" line. Returns false for anything
+        //  else.
+        static bool parse_line(std::string const & line,
+            std::string & cluster_id, std::string & proc)
+        {
+            std::string::size_type const size = line.size();
+            std::string::size_type i = 0;
+
+            std::string::size_type const cluster_begin = i;
+            while (i < size && is_digit(line[i]))
+                ++i;
+            std::string::size_type const cluster_end = i;
+
+            if (cluster_begin == cluster_end || i == size || ' ' != line[i])
+                return false;
+            while (i < size && ' ' == line[i])
+                ++i;
+
+            std::string::size_type const proc_begin = i;
+            while (i < size && is_digit(line[i]))
+                ++i;
+            std::string::size_type const proc_end = i;
+
+            // Trailing whitespace only.
+            while (i < size && is_space(line[i]))
+                ++i;
+
+            if (proc_begin == proc_end || i != size)
+                return false;
+
+            cluster_id.assign(line, cluster_begin, cluster_end - cluster_begin);
+            proc.assign(line, proc_begin, proc_end - proc_begin);
+            return true;
+        }
+
+        //  Reads condor_q output from is, handing job IDs to f, in pages of
+        //  up to page_size. A cluster's ID precedes those of its processes,
+        //  which condor_q lists together. Returns the number of IDs read.
+        std::size_t read(std::istream & is, page_callback const & f) const
+        {
+            std::vector<std::string> page;
+            page.reserve(config_.page_size);
+
+            std::size_t count = 0;
+            std::string last_cluster, cluster_id, proc;
+
+            for (std::string line; std::getline(is, line); )
+            {
+                if (!parse_line(line, cluster_id, proc))
+                    continue;
+
+                if (cluster_id != last_cluster)
+                {
+                    add(page, cluster_id, f);
+                    last_cluster = cluster_id;
+                    ++count;
+                }
+
+                if (config_.processes)
+                {
+                    add(page, cluster_id + "." + proc, f);
+                    ++count;
+                }
+            }
+
+            if (!page.empty())
+                f(page);
+
+            return count;
+        }
+
+        // Quotes str as a ClassAd string literal.
+        static std::string quote(std::string const & str)
+        {
+            std::string result = "\"";
+            for (std::size_t i = 0; i < str.size(); ++i)
+            {
+                if ('"' == str[i] || '\\' == str[i])
+                    result += '\\';
+                result += str[i];
+            }
+            return result + "\"";
+        }
+
+        config const & get_config() const
+        {
+            return config_;
+        }
+
+    private:
+        static bool is_digit(char c)
+        {
+            return c >= '0' && c <= '9';
+        }
+
+        static bool is_space(char c)
+        {
+            return ' ' == c || '\t' == c || '\r' == c;
+        }
+
+        static void append(std::string & constraint, std::string const & term)
+        {
+            if (!constraint.empty())
+                constraint += " && ";
+            constraint += term;
+        }
+
+        void add(std::vector<std::string> & page, std::string const & job_id,
+            page_callback const & f) const
+        {
+            page.push_back(job_id);
+            if (page.size() >= config_.page_size)
+            {
+                f(page);
+                page.clear();
+            }
+        }
+
+        config const config_;
+    };
+
+}}} // namespace saga::adaptors::condor
+
+#endif // include guard
@@ -7,6 +7,7 @@
 #include "shared_job_data.hpp"
 
 #include <boost/assert.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/version.hpp>
 
 // Backporting for Boost < 1.35
@@ -24,6 +25,8 @@
 
 namespace saga { namespace adaptors { namespace condor {
 
+    boost::detail::atomic_count shared_job_data::live_count_(0);
+
     job_registry::~job_registry()
     {
         // Once registered, jobs are not removed from the registry. Make
@@ -38,9 +41,15 @@ namespace saga { namespace adaptors { namespace condor {
     }
 
     void job_registry::register_job(boost::shared_ptr<shared_job_data> ptr)
+    {
+        register_job(get_cluster_id(ptr), ptr);
+    }
+
+    void job_registry::register_job(std::string const & id,
+            boost::shared_ptr<shared_job_data> ptr)
     {
         typedef job_map::mapped_type mapped_type;
-        mapped_type & job = jobs_[get_cluster_id(ptr)];
+        mapped_type & job = jobs_[id];
 
         BOOST_ASSERT(ptr != job
             && "Double registration: job is already registered.");
@@ -48,12 +57,15 @@ namespace saga { namespace adaptors { namespace condor {
             && "Duplicate job ID: Another job has registered this ID.");
 
         job = ptr;
+        update_summary(*ptr);
     }
 
     void job_registry::unregister_job(boost::shared_ptr<shared_job_data> ptr)
     {
         BOOST_VERIFY(jobs_.erase(get_cluster_id(ptr))
             && "Attempt to unregister job that is not registered.");
+
+        summaries_.erase(ptr->full_job_id);
     }
 
     boost::shared_ptr<shared_job_data>
@@ -67,4 +79,219 @@ namespace saga { namespace adaptors { namespace condor {
         return boost::shared_ptr<shared_job_data>();
     }
 
+    void job_registry::get_jobs(
+            std::vector<boost::shared_ptr<shared_job_data> > & out) const
+    {
+        // Jobs may be registered under more than one ID.
+        std::set<shared_job_data const *> seen;
+
+        job_map::const_iterator end = jobs_.end();
+        for (job_map::const_iterator it = jobs_.begin(); it != end; ++it)
+            if (seen.insert((*it).second.get()).second)
+                out.push_back((*it).second);
+    }
+
+    void job_registry::update_summary(shared_job_data const & job, int proc)
+    {
+        // Not submitted yet.
+        if (job.full_job_id.empty())
+            return;
+
+        summary & s = summaries_[job.full_job_id];
+        s.state = job.state;
+        s.exit_code = 0;
+
+        shared_job_data::attribute_map::const_iterator code
+            = job.attributes.find(saga::job::attributes::exitcode);
+        if (job.attributes.end() != code)
+        {
+            try
+            {
+                s.exit_code = boost::lexical_cast<int>((*code).second);
+            }
+            catch (boost::bad_lexical_cast const &)
+            {
+            }
+        }
+
+        // Events for a single process don't copy the whole table.
+        if (proc < 0 || std::size_t(proc) >= job.procs.size())
+            s.procs = job.procs;
+        else
+            s.procs.set(proc, job.procs.get(proc),
+                job.procs.get_exit_code(proc));
+    }
+
+    namespace {
+
+        void add_summary(std::vector<job_summary> & out,
+                std::string const & job_id, saga::job::state state,
+                int exit_code, std::set<std::string> const & job_ids,
+                std::set<saga::job::state> const & states)
+        {
+            if (!job_ids.empty() && !job_ids.count(job_id))
+                return;
+            if (!states.empty() && !states.count(state))
+                return;
+
+            job_summary summary;
+            summary.job_id = job_id;
+            summary.state = state;
+            summary.exit_code = exit_code;
+            summary.finished = saga::job::Done == state
+                || saga::job::Failed == state
+                || saga::job::Canceled == state;
+
+            out.push_back(summary);
+        }
+
+    } // namespace
+
+    void job_registry::snapshot(std::vector<job_summary> & out,
+            std::set<std::string> const & job_ids,
+            std::set<saga::job::state> const & states) const
+    {
+        summary_map::const_iterator end = summaries_.end();
+        for (summary_map::const_iterator it = summaries_.begin(); it != end;
+                ++it)
+        {
+            std::string const & job_id = (*it).first;
+            summary const & s = (*it).second;
+
+            add_summary(out, job_id, s.state, s.exit_code, job_ids, states);
+
+            std::size_t const procs = s.procs.size();
+            if (procs < 2)
+                continue;
+
+            // "[url]-[Cluster]" -> "[url]-[Cluster.Proc]"
+            std::string const prefix
+                = job_id.substr(0, job_id.size() - 1) + ".";
+            for (std::size_t proc = 0; proc < procs; ++proc)
+                add_summary(out,
+                    prefix + boost::lexical_cast<std::string>(proc) + "]",
+                    proc_table::to_saga_state(s.procs.get(proc)),
+                    s.procs.get_exit_code(proc), job_ids, states);
+        }
+    }
+
+    namespace {
+
+        // malloc's bookkeeping and rounding, on average, per heap block.
+        std::size_t const block_overhead = 2 * sizeof(void *);
+
+        // Nodes of std::map and std::set hold a color and three links
+        // besides their value.
+        std::size_t const node_overhead = 4 * sizeof(void *) + block_overhead;
+
+        // Heap bytes held by s. Short strings may be stored inline.
+        std::size_t string_bytes(std::string const & s)
+        {
+            static std::string::size_type const inline_capacity
+                = std::string().capacity();
+
+            if (s.capacity() <= inline_capacity)
+                return 0;
+            return s.capacity() + 1 + block_overhead;
+        }
+
+        // Attributes set on a SAGA job description. Its implementation is
+        // opaque, entries are costed as those of a map of strings.
+        std::size_t description_bytes(saga::job::description const & jd)
+        {
+            std::size_t bytes = 0;
+            try
+            {
+                std::vector<std::string> const names = jd.list_attributes();
+                for (std::size_t i = 0; i < names.size(); ++i)
+                {
+                    bytes += node_overhead + 2 * sizeof(std::string)
+                        + string_bytes(names[i]);
+
+                    if (jd.attribute_is_vector(names[i]))
+                    {
+                        std::vector<std::string> const values
+                            = jd.get_vector_attribute(names[i]);
+                        bytes += sizeof(std::vector<std::string>)
+                            + values.size() * sizeof(std::string);
+                        for (std::size_t j = 0; j < values.size(); ++j)
+                            bytes += string_bytes(values[j]);
+                    }
+                    else
+                        bytes += string_bytes(jd.get_attribute(names[i]));
+                }
+            }
+            catch (saga::exception const &)
+            {
+            }
+            return bytes;
+        }
+
+        // Bytes held by a job, including its shared_ptr's control block.
+        // Called with the job's state_change_mtx held. Bundles and DAGs are
+        // shared with other jobs, and not counted.
+        std::size_t job_bytes(shared_job_data const & job)
+        {
+            std::size_t bytes = sizeof(shared_job_data) + block_overhead
+                + 3 * sizeof(void *) + block_overhead;
+
+            bytes += string_bytes(job.full_job_id)
+                + string_bytes(job.cluster_id);
+
+            shared_job_data::attribute_map::const_iterator end
+                = job.attributes.end();
+            for (shared_job_data::attribute_map::const_iterator it
+                    = job.attributes.begin(); it != end; ++it)
+                bytes += node_overhead
+                    + sizeof(shared_job_data::attribute_map::value_type)
+                    + string_bytes((*it).first) + string_bytes((*it).second);
+
+            bytes += job.instances.size()
+                * (node_overhead + sizeof(job_cpi_impl *));
+
+            // A byte for each state, an int for each exit code.
+            if (job.procs.size())
+                bytes += job.procs.size() * (1 + sizeof(int))
+                    + 2 * block_overhead;
+
+            return bytes + description_bytes(job.description);
+        }
+
+    } // namespace
+
+    void job_registry::add_footprint(job_footprint & out) const
+    {
+        // Jobs may be registered under more than one ID.
+        std::set<shared_job_data const *> seen;
+
+        job_map::const_iterator end = jobs_.end();
+        for (job_map::const_iterator it = jobs_.begin(); it != end; ++it)
+        {
+            out.bytes += node_overhead + sizeof(job_map::value_type)
+                + string_bytes((*it).first);
+
+            shared_job_data & job = *(*it).second;
+            if (!seen.insert(&job).second)
+                continue;
+
+            shared_job_data::scoped_lock lock(job.state_change_mtx);
+
+            ++out.tracked;
+            out.bytes += job_bytes(job);
+        }
+
+        // Their summaries, for snapshot().
+        summary_map::const_iterator summaries_end = summaries_.end();
+        for (summary_map::const_iterator it = summaries_.begin();
+                it != summaries_end; ++it)
+        {
+            out.bytes += node_overhead + sizeof(summary_map::value_type)
+                + string_bytes((*it).first);
+
+            std::size_t const procs = (*it).second.procs.size();
+            if (procs)
+                out.bytes += procs * (1 + sizeof(int)) + 2 * block_overhead;
+        }
+    }
+
 }}} // namespace saga::adaptors::condor
@@ -6,10 +6,16 @@
 #ifndef SAGA_ADAPTORS_CONDOR_JOB_JOB_REGISTRY_HPP
 #define SAGA_ADAPTORS_CONDOR_JOB_JOB_REGISTRY_HPP
 
+#include "proc_table.hpp"
+
+#include <saga/saga/packages/job/job.hpp>
+
 #include <boost/shared_ptr.hpp>
 
 #include <map>
+#include <set>
 #include <string>
+#include <vector>
 
 namespace saga { namespace adaptors { namespace condor {
 
@@ -17,6 +23,45 @@ namespace saga { namespace adaptors { namespace condor {
     inline std::string const & get_cluster_id(
             boost::shared_ptr<shared_job_data>);
 
+    //  State of a tracked job, or of a process in a multi-process cluster,
+    //  as last reported by the log processor.
+    struct job_summary
+    {
+        job_summary()
+            : state(saga::job::Unknown)
+            , exit_code(0)
+            , finished(false)
+        {
+        }
+
+        std::string job_id;
+        saga::job::state state;
+        int exit_code;
+        bool finished;
+    };
+
+    //  Tracked jobs, and an estimate of the memory they hold.
+    struct job_footprint
+    {
+        job_footprint()
+            : live(0)
+            , tracked(0)
+            , bytes(0)
+        {
+        }
+
+        // shared_job_data instances alive, registered or not.
+        std::size_t live;
+
+        // Jobs registered, counted once however many IDs they have.
+        std::size_t tracked;
+
+        //  Bytes held by registered jobs, their descriptions and attributes,
+        //  and the registry entries for them. An estimate, from object and
+        //  string sizes and a per-node overhead of the standard containers.
+        std::size_t bytes;
+    };
+
     //  Maps Condor job IDs to job instances. It is suggested that job IDs be
     //  either "Cluster" or "Cluster.Process".
     //  A registry should be maintained per Condor pool, for the benefit of the
@@ -27,14 +72,57 @@ namespace saga { namespace adaptors { namespace condor {
     {
         ~job_registry();
 
+        //  Registration records the job's state, as update_summary() does.
+        //  Called with ptr's state_change_mtx held, or before ptr is shared
+        //  with other threads.
         void register_job(boost::shared_ptr<shared_job_data> ptr);
+
+        // Registers ptr under an additional ID, e.g., the name of a DAG
+        // node until DAGMan submits it.
+        void register_job(std::string const & id,
+            boost::shared_ptr<shared_job_data> ptr);
         void unregister_job(boost::shared_ptr<shared_job_data> ptr);
         boost::shared_ptr<shared_job_data> find_job(std::string const & id);
 
+        // Appends each registered job to out, once.
+        void get_jobs(
+            std::vector<boost::shared_ptr<shared_job_data> > & out) const;
+
+        //  Records the state of job, registered, for snapshot(). Called with
+        //  the job's state_change_mtx held, as the log processor or the
+        //  status poller change it. Only process proc is copied, if not
+        //  negative.
+        void update_summary(shared_job_data const & job, int proc = -1);
+
+        //  Appends the states of registered jobs, and of the processes of
+        //  multi-process clusters, to out, as last recorded. If not empty,
+        //  job_ids and states restrict the entries reported to those job
+        //  IDs and states. No job is locked, and no Condor command is
+        //  invoked.
+        void snapshot(std::vector<job_summary> & out,
+            std::set<std::string> const & job_ids = std::set<std::string>(),
+            std::set<saga::job::state> const & states
+                = std::set<saga::job::state>()) const;
+
+        //  Adds the registered jobs, and the bytes they hold, to out. Each
+        //  job is locked in turn. out.live is left alone.
+        void add_footprint(job_footprint & out) const;
+
     private:
         typedef std::map<std::string, boost::shared_ptr<shared_job_data> >
             job_map;
         job_map jobs_;
+
+        struct summary
+        {
+            saga::job::state state;
+            int exit_code;
+            proc_table procs;
+        };
+
+        // By full job ID. Jobs not submitted yet have none.
+        typedef std::map<std::string, summary> summary_map;
+        summary_map summaries_;
     };
 
 }}} // namespace saga::adaptors::condor
@@ -3,12 +3,27 @@
 //  Distributed under the Boost Software License, Version 1.0. (See accompanying
 //  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
+#include "admission_controller.hpp"
 #include "classad.hpp"
+#include "completion_queue.hpp"
 #include "condor_job.hpp"
+#include "dag_submitter.hpp"
 #include "log_processor.hpp"
+#include "queue_cache.hpp"
+#include "task_bundler.hpp"
+#include "temporary.hpp"
 
 #include <saga/saga-defs.hpp>
 
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/trim.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <unistd.h>
+
 namespace saga { namespace adaptors { namespace condor {
 
     void log_processor::process_log_entry(::condor::job::classad & c)
@@ -70,12 +85,41 @@ namespace saga { namespace adaptors { namespace condor {
         if ((attr = c.get_attribute("Proc")))
             process = attr->value_;
 
-        boost::shared_ptr<shared_job_data> job_data;
+        //  The queue snapshot may hold the cluster as it was before this
+        //  event, whether or not a job of ours is registered for it (e.g.,
+        //  one still reconnecting).
+        if (queue_cache_)
+            queue_cache_->invalidate(cluster);
+
+        //  Held while the event is processed, so the job's summary is
+        //  updated along with its state (see job_registry::snapshot).
+        synchronized<job_registry>::lock reg(registry_);
+
+        boost::shared_ptr<shared_job_data> job_data = reg->find_job(cluster);
+        if (!job_data)
+            job_data = reg->find_job(cluster + "." + process);
+
+        // DAGMan notes the node on submission of its job.
+        static std::string const dag_node_notes = "DAG Node: ";
+        if (!job_data && 0 == event_type
+                && (attr = c.get_attribute("LogNotes"))
+                && boost::starts_with(attr->value_, dag_node_notes))
         {
-            synchronized<job_registry>::lock reg(registry_);
-            job_data = reg->find_job(cluster);
-            if (!job_data)
-                job_data = reg->find_job(cluster + "." + process);
+            job_data = reg->find_job(boost::trim_copy(
+                attr->value_.substr(dag_node_notes.size())));
+
+            if (job_data)
+            {
+                shared_job_data::scoped_lock lock(job_data->state_change_mtx);
+
+                // Node is (re)submitted, start afresh.
+                std::size_t const procs = job_data->procs.size();
+                job_data->procs = proc_table();
+                job_data->procs.resize(procs);
+
+                job_data->cluster_id = cluster;
+                reg->register_job(job_data);
+            }
         }
 
         if (!job_data)
@@ -83,6 +127,10 @@ namespace saga { namespace adaptors { namespace condor {
 
         shared_job_data::scoped_lock lock(job_data->state_change_mtx);
 
+        saga::job::state state = job_data->state;
+        proc_table::proc_state proc_state = proc_table::idle;
+        shared_job_data::attribute_map attributes;
+
         // Event descriptions from section 2.6.6 of the Condor manual.
         // E.g., from here:
         // http://www.cs.wisc.edu/condor/manual/v7.1.0/2_6Managing_Job.html
@@ -93,13 +141,19 @@ namespace saga { namespace adaptors { namespace condor {
         //  This event occurs when a user submits a job.  It is the
         //  first event you will see for a job, and it should only occur
         //  once.
+        case 13:     // Job was released
+        //  The user is requesting that a job on hold be re-run.
+
+            state = saga::job::Running;
+            proc_state = proc_table::idle;
+            break;
+
         case 1:      // Job executing
         //  This shows up when a job is running. It might occur more
         //  than once.
-        case 13:     // Job was released
-        //  The user is requesting that a job on hold be re-run.
 
-            job_data->state = saga::job::Running;
+            state = saga::job::Running;
+            proc_state = proc_table::running;
             break;
 
         case 12:     // Job was held
@@ -107,7 +161,8 @@ namespace saga { namespace adaptors { namespace condor {
         //  command. It was stopped, and will go back into the queue
         //  again until it is aborted or released.
 
-            job_data->state = saga::job::Suspended;
+            state = saga::job::Suspended;
+            proc_state = proc_table::suspended;
             break;
 
         case 2:      // Error in executable
@@ -118,25 +173,28 @@ namespace saga { namespace adaptors { namespace condor {
         //  the computer, or perhaps another job is higher priority.
 
             if ((attr = c.get_attribute("EventTime")))
-                job_data->attributes[finished] = attr->value_;
+                attributes[finished] = attr->value_;
 
-            job_data->state = saga::job::Failed;
+            state = saga::job::Failed;
+            proc_state = proc_table::failed;
             break;
 
         case 5:      // Job terminated
         //  The job has completed.
 
             if ((attr = c.get_attribute("EventTime")))
-                job_data->attributes[finished] = attr->value_;
+                attributes[finished] = attr->value_;
             if ((attr = c.get_attribute("ReturnValue")))
-                job_data->attributes[exitcode] = attr->value_;
+                attributes[exitcode] = attr->value_;
 
-            job_data->state = saga::job::Done;
+            state = saga::job::Done;
+            proc_state = proc_table::done;
 
             if ((attr = c.get_attribute("TerminatedBySignal")))
             {
-                job_data->attributes[termsig] = attr->value_;
-                job_data->state = saga::job::Failed;
+                attributes[termsig] = attr->value_;
+                state = saga::job::Failed;
+                proc_state = proc_table::failed;
             }
 
             break;
@@ -145,9 +203,36 @@ namespace saga { namespace adaptors { namespace condor {
         //  The user cancelled the job.
 
             if ((attr = c.get_attribute("EventTime")))
-                job_data->attributes[finished] = attr->value_;
+                attributes[finished] = attr->value_;
 
-            job_data->state = saga::job::Canceled;
+            state = saga::job::Canceled;
+            proc_state = proc_table::canceled;
+            break;
+
+        case 16:     // POST script terminated
+        //  A node in a DAGMan workflow has a script that should be run
+        //  after a job. The script is run on the submit host.  This
+        //  event signals that the post script has completed.
+
+            if (!job_data->dag_post_script)
+                return;
+
+            // The script decides the fate of the node.
+            state = saga::job::Failed;
+            if ((attr = c.get_attribute("EventTime")))
+                attributes[finished] = attr->value_;
+            if ((attr = c.get_attribute("ReturnValue")))
+            {
+                attributes[exitcode] = attr->value_;
+
+                attr = c.get_attribute("TerminatedNormally");
+                if ("0" == attributes[exitcode]
+                        && attr && boost::iequals(attr->value_, "true"))
+                    state = saga::job::Done;
+            }
+
+            proc_state = (saga::job::Done == state)
+                ? proc_table::done : proc_table::failed;
             break;
 
         case 3:      // Job was checkpointed
@@ -183,11 +268,6 @@ namespace saga { namespace adaptors { namespace condor {
         case 15:     // Parallel node terminated
         //  A parallel (MPI) program has completed on a node.
 
-        case 16:     // POST script terminated
-        //  A node in a DAGMan workflow has a script that should be run
-        //  after a job. The script is run on the submit host.  This
-        //  event signals that the post script has completed.
-
         case 17:     // Job submitted to Globus
         //  A grid job has been delegated to Globus (version 2, 3, or
         //  4).
@@ -236,15 +316,236 @@ namespace saga { namespace adaptors { namespace condor {
             return;
         }
 
-        std::set<job_cpi_impl *>::iterator end = job_data->instances.end();
-        for (std::set<job_cpi_impl *>::iterator it = job_data->instances.begin();
-             it != end; ++it)
+        int proc = -1;
+        if (job_data->procs.size() > 1 && !process.empty()
+                && 16 != event_type)
+        {
+            // Multi-process cluster: track the process, the cluster is
+            // finished once all of its processes are.
+            try
+            {
+                proc = boost::lexical_cast<int>(process);
+            }
+            catch (boost::bad_lexical_cast const &)
+            {
+                return;
+            }
+
+            if (proc < 0)
+                return;
+
+            int exit_code = 0;
+            if (attributes.count(exitcode))
+            {
+                try
+                {
+                    exit_code = boost::lexical_cast<int>(attributes[exitcode]);
+                }
+                catch (boost::bad_lexical_cast const &)
+                {
+                }
+            }
+
+            job_data->procs.set(proc, proc_state, exit_code);
+
+            state = job_data->procs.get_aggregate_state();
+            if (job_data->procs.is_final())
+            {
+                if (attributes.count(finished))
+                    job_data->attributes[finished] = attributes[finished];
+                job_data->attributes[exitcode] = boost::lexical_cast<
+                    std::string>(job_data->procs.get_aggregate_exit_code());
+            }
+        }
+        else
+        {
+            shared_job_data::attribute_map::const_iterator end
+                = attributes.end();
+            for (shared_job_data::attribute_map::const_iterator it
+                    = attributes.begin(); it != end; ++it)
+                job_data->attributes[(*it).first] = (*it).second;
+        }
+
+        // DAG nodes with a POST script aren't finished before the script
+        // is.
+        if (job_data->dag_post_script && 16 != event_type
+                && (saga::job::Done == state || saga::job::Failed == state))
+            state = saga::job::Running;
+
+        job_data->state = state;
+
+        if (job_data->flow_controlled)
         {
-            (*it)->update_state(job_data->state, job_data->attributes);
+            // Held and finished processes don't count against max_idle.
+            std::size_t idle = 0;
+            if (saga::job::Running == state)
+                idle = (job_data->procs.size() > 1)
+                    ? job_data->procs.count(proc_table::idle)
+                    : (proc_table::idle == proc_state ? 1 : 0);
+
+            long const delta = long(idle) - long(job_data->idle_procs);
+            job_data->idle_procs = idle;
+
+            if (delta)
+                if (admission_controller * controller
+                        = job_data->pool_->find_admission_controller())
+                    controller->idle_changed(delta);
         }
-        job_data->state_change.notify_all();
+
+        notify(*job_data, proc);
+        reg->update_summary(*job_data, proc);
+
+        if (job_data->bundle)
+            process_bundle(reg.get(), *job_data);
+        if (job_data->dag)
+            process_dag(reg.get(), *job_data);
 
         _on_return.processed = true;
     }
 
+    void log_processor::notify(shared_job_data & job_data, int proc)
+    {
+        std::set<job_cpi_impl *>::iterator end = job_data.instances.end();
+        for (std::set<job_cpi_impl *>::iterator it = job_data.instances.begin();
+             it != end; ++it)
+        {
+            (*it)->update_state(job_data, proc);
+        }
+        job_data.state_change.notify_all();
+
+        if (queue_cache * cache = job_data.pool_
+                ? job_data.pool_->find_queue_cache() : 0)
+            if (!job_data.cluster_id.empty())
+                cache->invalidate(job_data.cluster_id);
+
+        completion_queue * queue = job_data.pool_
+            ? &job_data.pool_->get_completion_queue() : 0;
+        if (queue && !job_data.completion_reported
+                && !job_data.full_job_id.empty()
+                && job_data.is_state_final())
+        {
+            completion_queue::entry e;
+            e.job_id = job_data.full_job_id;
+            e.state = job_data.state;
+
+            shared_job_data::attribute_map::const_iterator exit_code
+                = job_data.attributes.find(saga::job::attributes::exitcode);
+            if (job_data.attributes.end() != exit_code)
+            {
+                try
+                {
+                    e.exit_code = boost::lexical_cast<int>(
+                        (*exit_code).second);
+                }
+                catch (boost::bad_lexical_cast const &)
+                {
+                }
+            }
+
+            queue->push(e);
+            job_data.completion_reported = true;
+        }
+    }
+
+    void log_processor::process_bundle(job_registry & registry,
+            shared_job_data & bundle_job)
+    {
+        using namespace saga::job::attributes;
+
+        job_bundle & bundle = *bundle_job.bundle;
+        std::size_t const count = bundle.tasks.size();
+
+        saga::job::state const state = bundle_job.state;
+        bool const is_final = saga::job::Done == state
+            || saga::job::Failed == state
+            || saga::job::Canceled == state;
+
+        // Exit codes reported by the wrapper script, once it's finished.
+        std::vector<int> exit_codes;
+        std::vector<bool> reported;
+
+        if (is_final)
+        {
+            exit_codes.resize(count, 0);
+            reported.resize(count, false);
+
+            std::ifstream results(bundle.results.c_str());
+            task_bundler::read_results(results, exit_codes, reported);
+            results.close();
+
+            ::unlink(bundle.results.c_str());
+            bundle.wrapper.reset();
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            shared_job_data & task = *bundle.tasks[i];
+            shared_job_data::scoped_lock lock(task.state_change_mtx);
+
+            if (is_final)
+            {
+                if (reported[i])
+                {
+                    task.state = saga::job::Done;
+                    task.attributes[exitcode]
+                        = boost::lexical_cast<std::string>(exit_codes[i]);
+                }
+                else
+                {
+                    // Task never ran, or the wrapper didn't get to report on
+                    // it.
+                    task.state = (saga::job::Done == state)
+                        ? saga::job::Failed : state;
+                }
+
+                shared_job_data::attribute_map::const_iterator it
+                    = bundle_job.attributes.find(finished);
+                if (bundle_job.attributes.end() != it)
+                    task.attributes[finished] = (*it).second;
+            }
+            else
+                task.state = state;
+
+            notify(task, -1);
+            registry.update_summary(task);
+        }
+
+        // Tasks are finished, no more updates.
+        if (is_final)
+            bundle.tasks.clear();
+    }
+
+    void log_processor::process_dag(job_registry & registry,
+            shared_job_data & dagman_job)
+    {
+        saga::job::state const state = dagman_job.state;
+        if (saga::job::Done != state
+                && saga::job::Failed != state
+                && saga::job::Canceled != state)
+            return;
+
+        // Nodes DAGMan didn't get to run, or whose jobs were removed along
+        // with DAGMan.
+        dag_workflow & dag = *dagman_job.dag;
+        std::size_t const count = dag.nodes.size();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            shared_job_data & node = *dag.nodes[i];
+            shared_job_data::scoped_lock lock(node.state_change_mtx);
+
+            if (saga::job::Done == node.state
+                    || saga::job::Failed == node.state
+                    || saga::job::Canceled == node.state)
+                continue;
+
+            node.state = (saga::job::Canceled == state)
+                ? saga::job::Canceled : saga::job::Failed;
+            notify(node, -1);
+            registry.update_summary(node);
+        }
+
+        // Removes the DAG and DAGMan's files.
+        dagman_job.dag.reset();
+    }
+
 }}} // namespace saga::adaptors::condor
@@ -20,6 +20,7 @@
 #include <boost/spirit/core/parser.hpp>
 #endif
 #include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/thread.hpp>
 #include <boost/thread/condition.hpp>
 #include <boost/version.hpp>
@@ -29,15 +30,22 @@
 
 namespace saga { namespace adaptors { namespace condor {
 
+    struct queue_cache;
+
     struct log_processor
     {
         // avoid warning about using this in constructor initializer list
         log_processor* This() { return this; }
 
+        //  Events drop their cluster from cache, if given, whether the
+        //  cluster is registered or not.
         log_processor(std::string const & filename,
-                synchronized<job_registry> & registry)
+                synchronized<job_registry> & registry,
+                boost::shared_ptr<queue_cache> const & cache
+                    = boost::shared_ptr<queue_cache>())
             : filename_(filename)
             , registry_(registry)
+            , queue_cache_(cache)
         #if BOOST_VERSION < 103500
             , interrupt_thread_(false)
         #endif
@@ -68,6 +76,10 @@ namespace saga { namespace adaptors { namespace condor {
 
         void process_log_entry(::condor::job::classad & c);
 
+        // Propagates state changes to CPI instances. Called with the job's
+        // state_change_mtx held.
+        static void notify(shared_job_data & job_data, int proc);
+
         void operator()()
         {
             detail::tail_reader log(filename_);
@@ -142,6 +154,12 @@ namespace saga { namespace adaptors { namespace condor {
                     std::deque<char>::iterator iter = data.begin();
 
                     bool hit = c.find_and_parse(iter, data.end());
+
+                    // The next entry may start with the last character
+                    // read, "<" of "<c>". Keep it.
+                    if (!hit && data.end() == iter && '<' == data.back())
+                        --iter;
+
                     data.erase(data.begin(), iter);
 
                     if (hit)
@@ -161,8 +179,21 @@ namespace saga { namespace adaptors { namespace condor {
         }
 
     private:
+        // Fans out state changes of a bundle of tasks to the individual
+        // tasks. Called with the registry locked and the bundle's
+        // state_change_mtx held.
+        void process_bundle(job_registry & registry,
+            shared_job_data & bundle_job);
+
+        // Settles nodes of a DAG that are left over once the DAGMan job
+        // terminates. Called with the registry locked and the DAGMan job's
+        // state_change_mtx held.
+        void process_dag(job_registry & registry,
+            shared_job_data & dagman_job);
+
         std::string filename_;
         synchronized<job_registry> & registry_;
+        boost::shared_ptr<queue_cache> queue_cache_;
 
     #if BOOST_VERSION < 103500
         volatile bool interrupt_thread_;
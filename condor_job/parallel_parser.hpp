@@ -0,0 +1,163 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_PARALLEL_PARSER_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_PARALLEL_PARSER_HPP
+
+#include "classad.hpp"
+
+#include <boost/bind.hpp>
+#include <boost/optional.hpp>
+#include <boost/thread.hpp>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    //  Parses a buffer of XML ClassAds (e.g., condor_q -xml output for a
+    //  large cluster) on several threads. The buffer is split at "<c>"
+    //  boundaries into one contiguous range per thread, and each ClassAd is
+    //  reduced to a projection, of type T, as it is parsed:
+    //
+    //      T projection(::condor::job::classad const &);
+    //
+    //  Buffers too small to be worth the threads are parsed on the calling
+    //  thread.
+    struct parallel_parser
+    {
+        //  threads: at most this many threads are used, 0 for one per core.
+        //  min_bytes: each thread gets at least this much of the buffer.
+        explicit parallel_parser(std::size_t threads = 0,
+                std::size_t min_bytes = 256 * 1024)
+            : threads_(threads ? threads : boost::thread::hardware_concurrency())
+            , min_bytes_(min_bytes ? min_bytes : 1)
+        {
+            if (!threads_)
+                threads_ = 1;
+        }
+
+        //  Appends projections of the ClassAds in xml to out, in the order
+        //  they appear in xml.
+        template <class T, class Projection>
+        void parse(std::string const & xml, Projection projection,
+            std::vector<T> & out) const
+        {
+            std::vector<range> ranges = split(xml);
+            std::vector<std::vector<T> > results(ranges.size());
+
+            if (1 == ranges.size())
+                parse_range(xml, ranges[0], projection, results[0]);
+            else
+            {
+                boost::thread_group workers;
+                for (std::size_t i = 0; i < ranges.size(); ++i)
+                    workers.create_thread(boost::bind(
+                        &parallel_parser::parse_range<T, Projection>,
+                        boost::cref(xml), ranges[i], projection,
+                        boost::ref(results[i])));
+                workers.join_all();
+            }
+
+            for (std::size_t i = 0; i < results.size(); ++i)
+                out.insert(out.end(), results[i].begin(), results[i].end());
+        }
+
+        //  As above, keyed by "ClusterId.ProcId". ClassAds lacking either
+        //  are skipped, later ones replace earlier ones with the same key.
+        template <class T, class Projection>
+        void parse(std::string const & xml, Projection projection,
+            std::map<std::string, T> & out) const
+        {
+            std::vector<std::pair<std::string, T> > keyed;
+            parse(xml, keyed_projection<T, Projection>(projection), keyed);
+
+            for (std::size_t i = 0; i < keyed.size(); ++i)
+                if (!keyed[i].first.empty())
+                    out[keyed[i].first] = keyed[i].second;
+        }
+
+    private:
+        typedef std::pair<std::size_t, std::size_t> range;
+
+        template <class T, class Projection>
+        struct keyed_projection
+        {
+            explicit keyed_projection(Projection const & p)
+                : projection(p)
+            {
+            }
+
+            std::pair<std::string, T> operator()(
+                ::condor::job::classad const & ca)
+            {
+                boost::optional< ::condor::job::classad::value>
+                    cluster = ca.get_attribute("ClusterId"),
+                    proc    = ca.get_attribute("ProcId");
+
+                std::pair<std::string, T> result;
+                result.second = projection(ca);
+                if (cluster && proc)
+                    result.first = cluster->value_ + "." + proc->value_;
+
+                return result;
+            }
+
+            Projection projection;
+        };
+
+        std::vector<range> split(std::string const & xml) const
+        {
+            std::size_t const count = (std::max)(std::size_t(1),
+                (std::min)(threads_, xml.size() / min_bytes_));
+            std::size_t const step = xml.size() / count;
+
+            std::vector<range> ranges;
+
+            std::size_t begin = 0;
+            for (std::size_t i = 1; i < count; ++i)
+            {
+                std::string::size_type end = xml.find("<c>", i * step);
+                if (std::string::npos == end)
+                    break;
+                if (end <= begin)
+                    continue;
+
+                ranges.push_back(range(begin, end));
+                begin = end;
+            }
+            ranges.push_back(range(begin, xml.size()));
+
+            return ranges;
+        }
+
+        template <class T, class Projection>
+        static void parse_range(std::string const & xml, range r,
+            Projection projection, std::vector<T> & out)
+        {
+            std::string::const_iterator first = xml.begin() + r.first;
+            std::string::const_iterator const last = xml.begin() + r.second;
+
+            // A fresh ClassAd for each record, so attributes don't carry
+            // over from one to the next.
+            for (;;)
+            {
+                ::condor::job::classad ca;
+                if (!ca.find_and_parse(first, last))
+                    break;
+
+                out.push_back(projection(ca));
+            }
+        }
+
+        std::size_t threads_;
+        std::size_t min_bytes_;
+    };
+
+}}} // namespace saga::adaptors::condor
+
+#endif // include guard
@@ -3,22 +3,43 @@
 //  Distributed under the Boost Software License, Version 1.0. (See accompanying
 //  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
+#include "admission_controller.hpp"
+#include "clock.hpp"
+#include "command_batcher.hpp"
+#include "completion_queue.hpp"
+#include "condor_job_adaptor.hpp"
+#include "dag_submitter.hpp"
 #include "log_processor.hpp"
 #include "pool_data.hpp"
+#include "queue_cache.hpp"
+#include "status_poller.hpp"
+#include "submit_governor.hpp"
+#include "task_bundler.hpp"
 #include "temporary.hpp"
 
 namespace saga { namespace adaptors { namespace condor {
 
     // NOTE: We need the empty constructors and destructors here, to make sure
-    // scoped_ptr<...> has complete definitions of log_processor and
-    // temporary_file available and to avoid cyclical header dependencies.
+    // scoped_ptr<...> has complete definitions of log_processor,
+    // task_bundler, dag_submitter, admission_controller, submit_governor,
+    // completion_queue, command_batcher, status_poller and temporary_file
+    // available and to avoid cyclical header dependencies.
 
-    pool::pool(std::string const & url, std::string const & log)
-        : url_(url), log_(log)
+    pool::pool(std::string const & url, std::string const & log,
+            boost::shared_ptr<queue_cache> const & cache)
+        : url_(url), log_(log), log_start_(-1.)
+        , completion_queue_(new completion_queue), queue_cache_(cache)
     {
     }
 
-    pool::~pool() {}
+    pool::~pool()
+    {
+        // The log processor and the status poller dispatch events to the
+        // admission controller, completion queue and queue cache from their
+        // own threads. Stop them before any of those is destroyed.
+        status_poller_.reset();
+        log_processor_.reset();
+    }
 
     std::string const & pool::get_log()
     {
@@ -35,9 +56,82 @@ namespace saga { namespace adaptors { namespace condor {
         //          the Cluster ID :-/
 
         if (!log_processor_)
-            log_processor_.reset(new log_processor(log_, registry_));
+        {
+            log_processor_.reset(new log_processor(log_, registry_,
+                queue_cache_));
+            log_start_ = detail::now();
+        }
 
         return log_;
     }
 
+    double pool::get_log_start()
+    {
+        synchronized<job_registry>::lock lck(registry_);
+        return log_start_;
+    }
+
+    task_bundler & pool::get_bundler(job_adaptor const & adaptor)
+    {
+        synchronized<job_registry>::lock lck(registry_);
+
+        if (!bundler_)
+            bundler_.reset(new task_bundler(adaptor, *this));
+
+        return *bundler_;
+    }
+
+    dag_submitter & pool::get_dag_submitter(job_adaptor const & adaptor)
+    {
+        synchronized<job_registry>::lock lck(registry_);
+
+        if (!dag_submitter_)
+            dag_submitter_.reset(new dag_submitter(adaptor, *this));
+
+        return *dag_submitter_;
+    }
+
+    admission_controller & pool::get_admission_controller(
+            job_adaptor const & adaptor)
+    {
+        synchronized<job_registry>::lock lck(registry_);
+
+        if (!admission_controller_)
+            admission_controller_.reset(
+                new admission_controller(adaptor, *this));
+
+        return *admission_controller_;
+    }
+
+    submit_governor & pool::get_submit_governor(job_adaptor const & adaptor)
+    {
+        synchronized<job_registry>::lock lck(registry_);
+
+        if (!submit_governor_)
+            submit_governor_.reset(
+                new submit_governor(adaptor.get_submit_control_config()));
+
+        return *submit_governor_;
+    }
+
+    command_batcher & pool::get_command_batcher(job_adaptor const & adaptor)
+    {
+        synchronized<job_registry>::lock lck(registry_);
+
+        if (!command_batcher_)
+            command_batcher_.reset(new command_batcher(adaptor));
+
+        return *command_batcher_;
+    }
+
+    status_poller & pool::get_status_poller(job_adaptor const & adaptor)
+    {
+        synchronized<job_registry>::lock lck(registry_);
+
+        if (!status_poller_)
+            status_poller_.reset(new status_poller(adaptor, *this));
+
+        return *status_poller_;
+    }
+
 }}} // namespace saga::adaptors::condor
@@ -16,17 +16,32 @@
 
 namespace saga { namespace adaptors { namespace condor {
 
+    class job_adaptor;
     class job_cpi_impl;
+    struct admission_controller;
+    struct command_batcher;
+    struct completion_queue;
+    struct dag_submitter;
     struct log_processor;
+    struct queue_cache;
+    struct status_poller;
+    struct submit_governor;
+    struct task_bundler;
     struct temporary_file;
 
     struct pool
     {
-        pool(std::string const & url, std::string const & log);
+        pool(std::string const & url, std::string const & log,
+            boost::shared_ptr<queue_cache> const & cache
+                = boost::shared_ptr<queue_cache>());
         ~pool();
 
         std::string const & get_log();
 
+        //  Time log processing started (see detail::now()), or -1 if it
+        //  hasn't. Events logged before then aren't seen.
+        double get_log_start();
+
         std::string const & get_url() const
         {
             return url_;
@@ -37,12 +52,53 @@ namespace saga { namespace adaptors { namespace condor {
             return registry_;
         }
 
+        task_bundler & get_bundler(job_adaptor const & adaptor);
+        dag_submitter & get_dag_submitter(job_adaptor const & adaptor);
+
+        admission_controller & get_admission_controller(
+            job_adaptor const & adaptor);
+
+        submit_governor & get_submit_governor(job_adaptor const & adaptor);
+        command_batcher & get_command_batcher(job_adaptor const & adaptor);
+
+        // For pools without a readable job log.
+        status_poller & get_status_poller(job_adaptor const & adaptor);
+
+        //  Jobs finishing are reported here. The queue lives as long as the
+        //  pool, so the log processor can reach it without locking.
+        completion_queue & get_completion_queue()
+        {
+            return *completion_queue_;
+        }
+
+        // Without creating one. For the log processor.
+        admission_controller * find_admission_controller()
+        {
+            synchronized<job_registry>::lock lck(registry_);
+            return admission_controller_.get();
+        }
+
+        // Snapshot of the schedd's queue, shared with other pools on url.
+        queue_cache * find_queue_cache() const
+        {
+            return queue_cache_.get();
+        }
+
     private:
         std::string const                   url_;
         std::string                         log_;
+        double                              log_start_;
         synchronized<job_registry>          registry_;
         boost::scoped_ptr<temporary_file>   temp_log_;
         boost::scoped_ptr<log_processor>    log_processor_;
+        boost::scoped_ptr<task_bundler>     bundler_;
+        boost::scoped_ptr<dag_submitter>    dag_submitter_;
+        boost::scoped_ptr<admission_controller> admission_controller_;
+        boost::scoped_ptr<submit_governor>  submit_governor_;
+        boost::scoped_ptr<completion_queue> completion_queue_;
+        boost::scoped_ptr<command_batcher>  command_batcher_;
+        boost::scoped_ptr<status_poller>    status_poller_;
+        boost::shared_ptr<queue_cache>      queue_cache_;
     };
 
 }}} // namespace saga::adaptors::condor
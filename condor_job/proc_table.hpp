@@ -0,0 +1,195 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_PROC_TABLE_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_PROC_TABLE_HPP
+
+#include <saga/saga/packages/job/job.hpp>
+
+#include <boost/assert.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    //  Tracks the state of individual processes in a multi-process cluster.
+    //
+    //  States and exit codes are kept in dense arrays indexed by ProcId, so
+    //  large clusters cost a byte per process for the state, and an int for
+    //  the exit code, which may be negative or above 255 (e.g., on
+    //  Windows). Per-state counts are kept up to date on every change,
+    //  making the aggregate state of the cluster cheap to compute.
+    //
+    //  NOTE: This is NOT thread-safe. Access is protected by the owning
+    //  shared_job_data's state_change_mtx.
+    struct proc_table
+    {
+        enum proc_state
+        {
+            idle = 0,
+            running,
+            suspended,
+            done,
+            failed,
+            canceled,
+
+            state_count
+        };
+
+        proc_table()
+        {
+            for (int i = 0; i < state_count; ++i)
+                counts_[i] = 0;
+        }
+
+        // Grows the table to hold n processes. New processes start as idle.
+        void resize(std::size_t n)
+        {
+            if (n <= states_.size())
+                return;
+
+            counts_[idle] += n - states_.size();
+            states_.resize(n, idle);
+            exit_codes_.resize(n, 0);
+        }
+
+        std::size_t size() const
+        {
+            return states_.size();
+        }
+
+        proc_state get(std::size_t proc) const
+        {
+            BOOST_ASSERT(proc < states_.size() && "ProcId out of range.");
+            return proc_state(states_[proc]);
+        }
+
+        int get_exit_code(std::size_t proc) const
+        {
+            BOOST_ASSERT(proc < exit_codes_.size() && "ProcId out of range.");
+            return exit_codes_[proc];
+        }
+
+        void set(std::size_t proc, proc_state state, int exit_code = 0)
+        {
+            BOOST_ASSERT(state < state_count && "Invalid process state.");
+
+            resize(proc + 1);
+
+            --counts_[states_[proc]];
+            ++counts_[state];
+
+            states_[proc] = static_cast<unsigned char>(state);
+            exit_codes_[proc] = exit_code;
+        }
+
+        std::size_t count(proc_state state) const
+        {
+            BOOST_ASSERT(state < state_count && "Invalid process state.");
+            return counts_[state];
+        }
+
+        std::size_t count_final() const
+        {
+            return counts_[done] + counts_[failed] + counts_[canceled];
+        }
+
+        bool is_final() const
+        {
+            return !states_.empty() && count_final() == states_.size();
+        }
+
+        //  The cluster is Running while any process is idle or running, and
+        //  Suspended if all remaining processes are held. Once all processes
+        //  are finished it is Done, unless any process failed or was
+        //  canceled.
+        saga::job::state get_aggregate_state() const
+        {
+            if (states_.empty())
+                return saga::job::Unknown;
+
+            if (counts_[idle] || counts_[running])
+                return saga::job::Running;
+            if (counts_[suspended])
+                return saga::job::Suspended;
+            if (counts_[failed])
+                return saga::job::Failed;
+            if (counts_[canceled])
+                return saga::job::Canceled;
+
+            return saga::job::Done;
+        }
+
+        //  Exit code of the first process with a non-zero exit code, or 0.
+        int get_aggregate_exit_code() const
+        {
+            std::size_t const n = exit_codes_.size();
+            for (std::size_t i = 0; i < n; ++i)
+                if (exit_codes_[i])
+                    return exit_codes_[i];
+
+            return 0;
+        }
+
+        // From Condor's JobStatus attribute.
+        static proc_state from_status(int job_status)
+        {
+            switch (job_status)
+            {
+            case 2:     // Running
+                return running;
+
+            case 3:     // Removed
+                return canceled;
+
+            case 4:     // Completed
+                return done;
+
+            case 5:     // Held
+                return suspended;
+
+            case 6:     // Submission error
+                return failed;
+
+            default:    // Idle, Unexpanded
+                return idle;
+            }
+        }
+
+        static saga::job::state to_saga_state(proc_state state)
+        {
+            switch (state)
+            {
+            case idle:
+            case running:
+                return saga::job::Running;
+
+            case suspended:
+                return saga::job::Suspended;
+
+            case done:
+                return saga::job::Done;
+
+            case failed:
+                return saga::job::Failed;
+
+            case canceled:
+                return saga::job::Canceled;
+
+            default:
+                return saga::job::Unknown;
+            }
+        }
+
+    private:
+        std::vector<unsigned char> states_;
+        std::vector<int> exit_codes_;
+        std::size_t counts_[state_count];
+    };
+
+}}} // namespace saga::adaptors::condor
+
+#endif // include guard
@@ -0,0 +1,601 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "process.hpp"
+
+#include <boost/config.hpp>
+
+#if defined(BOOST_WINDOWS)
+#   include <boost/process.hpp>
+#else
+#   include <cerrno>
+#   include <cstdlib>
+#   include <cstring>
+#   include <fcntl.h>
+#   include <pthread.h>
+#   include <signal.h>
+#   include <spawn.h>
+#   include <sys/types.h>
+#   include <sys/wait.h>
+#   include <unistd.h>
+
+extern char ** environ;
+#endif
+
+#include <stdexcept>
+#include <streambuf>
+
+///////////////////////////////////////////////////////////////////////////////
+//  this is a hack to make boost::process work (avoid multiple definitions)
+//  (this will go away as soon as it is fixed in Boost.Process)
+#if defined(BOOST_PROCESS_WIN32_API)
+const boost::process::detail::file_handle::handle_type 
+    boost::process::detail::file_handle::INVALID_VALUE = INVALID_HANDLE_VALUE;
+#endif
+
+namespace saga { namespace adaptors { namespace condor {
+
+#if defined(BOOST_WINDOWS)
+
+    //  No posix_spawn here, Boost.Process does the work.
+
+    struct child_process::impl
+    {
+        explicit impl(boost::process::child const & c)
+            : child(c)
+        {
+        }
+
+        boost::process::child child;
+    };
+
+    std::ostream & child_process::get_stdin()
+    {
+        return impl_->child.get_stdin();
+    }
+
+    std::istream & child_process::get_stdout()
+    {
+        return impl_->child.get_stdout();
+    }
+
+    void child_process::close_stdin()
+    {
+        impl_->child.get_stdin().close();
+    }
+
+    process_status child_process::wait()
+    {
+        boost::process::status status = impl_->child.wait();
+        return process_status(status.exited(),
+            status.exited() ? status.exit_status() : -1);
+    }
+
+    void child_process::kill()
+    {
+        impl_->child.terminate();
+    }
+
+#else // !defined(BOOST_WINDOWS)
+
+    namespace {
+
+        struct fd_inbuf
+            : std::streambuf
+        {
+            explicit fd_inbuf(int fd)
+                : fd_(fd)
+            {
+                setg(buffer_, buffer_, buffer_);
+            }
+
+        protected:
+            int_type underflow()
+            {
+                if (gptr() < egptr())
+                    return traits_type::to_int_type(*gptr());
+
+                if (-1 == fd_)
+                    return traits_type::eof();
+
+                ssize_t count;
+                do
+                    count = ::read(fd_, buffer_, sizeof(buffer_));
+                while (-1 == count && EINTR == errno);
+
+                if (count <= 0)
+                    return traits_type::eof();
+
+                setg(buffer_, buffer_, buffer_ + count);
+                return traits_type::to_int_type(*gptr());
+            }
+
+        private:
+            int fd_;
+            char buffer_[4096];
+        };
+
+        //  Writing to a pipe no one reads from anymore raises SIGPIPE, which
+        //  by default kills the application. Blocks SIGPIPE on the calling
+        //  thread while in scope, and discards one raised meanwhile. The
+        //  write fails with EPIPE instead.
+        struct sigpipe_blocker
+        {
+            sigpipe_blocker()
+            {
+                sigemptyset(&sigpipe_);
+                sigaddset(&sigpipe_, SIGPIPE);
+
+                // Already blocked and pending, ours would merge with it.
+                sigset_t pending;
+                sigpending(&pending);
+                was_pending_ = sigismember(&pending, SIGPIPE);
+
+                if (!was_pending_)
+                    pthread_sigmask(SIG_BLOCK, &sigpipe_, &old_mask_);
+            }
+
+            ~sigpipe_blocker()
+            {
+                if (was_pending_)
+                    return;
+
+                sigset_t pending;
+                sigpending(&pending);
+                if (sigismember(&pending, SIGPIPE))
+                {
+                    int sig;
+                    sigwait(&sigpipe_, &sig);
+                }
+
+                pthread_sigmask(SIG_SETMASK, &old_mask_, 0);
+            }
+
+        private:
+            sigset_t sigpipe_;
+            sigset_t old_mask_;
+            bool was_pending_;
+        };
+
+        struct fd_outbuf
+            : std::streambuf
+        {
+            explicit fd_outbuf(int fd)
+                : fd_(fd)
+            {
+                setp(buffer_, buffer_ + sizeof(buffer_));
+            }
+
+            void close()
+            {
+                sync();
+                fd_ = -1;
+            }
+
+        protected:
+            int_type overflow(int_type c)
+            {
+                if (!flush_buffer())
+                    return traits_type::eof();
+
+                if (!traits_type::eq_int_type(c, traits_type::eof()))
+                {
+                    *pptr() = traits_type::to_char_type(c);
+                    pbump(1);
+                }
+
+                return traits_type::not_eof(c);
+            }
+
+            int sync()
+            {
+                return flush_buffer() ? 0 : -1;
+            }
+
+        private:
+            bool flush_buffer()
+            {
+                char const * data = pbase();
+                std::size_t size = pptr() - pbase();
+                setp(buffer_, buffer_ + sizeof(buffer_));
+
+                if (-1 == fd_)
+                    return 0 == size;
+                if (!size)
+                    return true;
+
+                sigpipe_blocker blocker;
+                while (size)
+                {
+                    ssize_t count = ::write(fd_, data, size);
+                    if (-1 == count)
+                    {
+                        if (EINTR == errno)
+                            continue;
+                        return false;
+                    }
+
+                    data += count;
+                    size -= count;
+                }
+
+                return true;
+            }
+
+            int fd_;
+            char buffer_[4096];
+        };
+
+        // Pipe with both ends closed on exec.
+        void make_pipe(int fds[2])
+        {
+#if defined(__linux__)
+            if (0 == ::pipe2(fds, O_CLOEXEC))
+                return;
+#else
+            if (0 == ::pipe(fds))
+            {
+                ::fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+                ::fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+                return;
+            }
+#endif
+
+            throw std::runtime_error(std::string("Failed to create pipe: ")
+                + std::strerror(errno));
+        }
+
+        void close_fd(int & fd)
+        {
+            if (-1 != fd)
+            {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+
+        struct file_actions
+        {
+            file_actions()
+            {
+                posix_spawn_file_actions_init(&actions);
+            }
+
+            ~file_actions()
+            {
+                posix_spawn_file_actions_destroy(&actions);
+            }
+
+            posix_spawn_file_actions_t actions;
+        };
+
+    } // namespace
+
+    struct child_process::impl
+    {
+        impl(pid_t p, int in, int out)
+            : pid(p)
+            , stdin_fd(in)
+            , stdout_fd(out)
+            , inbuf(out)
+            , outbuf(in)
+            , input(&outbuf)
+            , output(&inbuf)
+            , waited(false)
+        {
+        }
+
+        ~impl()
+        {
+            close_input();
+            close_fd(stdout_fd);
+
+            // Don't leave zombies behind.
+            if (!waited)
+                wait();
+        }
+
+        void close_input()
+        {
+            input.flush();
+            outbuf.close();
+            close_fd(stdin_fd);
+        }
+
+        process_status wait()
+        {
+            if (waited)
+                return status;
+
+            close_input();
+
+            // Wait for the process to exit, but leave it unreaped until
+            // kill() can no longer target its pid.
+            siginfo_t info;
+            int r;
+            do
+                r = ::waitid(P_PID, pid, &info, WEXITED | WNOWAIT);
+            while (-1 == r && EINTR == errno);
+
+            boost::mutex::scoped_lock lock(mtx);
+
+            int result;
+            pid_t p;
+            do
+                p = ::waitpid(pid, &result, 0);
+            while (-1 == p && EINTR == errno);
+
+            waited = true;
+            if (p == pid && WIFEXITED(result))
+                status = process_status(true, WEXITSTATUS(result));
+
+            return status;
+        }
+
+        void kill()
+        {
+            boost::mutex::scoped_lock lock(mtx);
+            if (!waited)
+                ::kill(pid, SIGKILL);
+        }
+
+        pid_t pid;
+        int stdin_fd;
+        int stdout_fd;
+
+        fd_inbuf inbuf;
+        fd_outbuf outbuf;
+        std::ostream input;
+        std::istream output;
+
+        boost::mutex mtx;
+        bool waited;
+        process_status status;
+    };
+
+    std::ostream & child_process::get_stdin()
+    {
+        return impl_->input;
+    }
+
+    std::istream & child_process::get_stdout()
+    {
+        return impl_->output;
+    }
+
+    void child_process::close_stdin()
+    {
+        impl_->close_input();
+    }
+
+    process_status child_process::wait()
+    {
+        return impl_->wait();
+    }
+
+    void child_process::kill()
+    {
+        impl_->kill();
+    }
+
+#endif // !defined(BOOST_WINDOWS)
+
+    process_launcher::process_launcher()
+        : custom_environment_(false)
+    {
+    }
+
+    void process_launcher::set_search_path(std::string const & path)
+    {
+        search_path_ = path;
+
+        boost::mutex::scoped_lock lock(executables_mtx_);
+        executables_.clear();
+    }
+
+    void process_launcher::clear_environment()
+    {
+        custom_environment_ = true;
+        environment_.clear();
+        update_environment();
+    }
+
+    void process_launcher::set_environment(std::string const & name,
+            std::string const & value)
+    {
+        custom_environment_ = true;
+        environment_[name] = value;
+        update_environment();
+    }
+
+    void process_launcher::update_environment()
+    {
+        env_block_.clear();
+        envp_.clear();
+
+        std::map<std::string, std::string>::const_iterator end
+            = environment_.end();
+        for (std::map<std::string, std::string>::const_iterator it
+                = environment_.begin(); it != end; ++it)
+            env_block_.push_back((*it).first + "=" + (*it).second);
+
+        // Pointers are taken once the block is complete.
+        for (std::size_t i = 0; i < env_block_.size(); ++i)
+            envp_.push_back(&env_block_[i][0]);
+        envp_.push_back(0);
+    }
+
+#if defined(BOOST_WINDOWS)
+
+    std::string process_launcher::find_executable(
+            std::string const & command) const
+    {
+        return command;
+    }
+
+    child_process process_launcher::start(std::string const & command,
+            std::vector<std::string> const & arguments,
+            stream_behavior stdin_behavior,
+            stream_behavior stdout_behavior,
+            stream_behavior stderr_behavior) const
+    {
+        namespace bp = boost::process;
+
+        bp::command_line cl(command, "", search_path_);
+        for (std::size_t i = 0; i < arguments.size(); ++i)
+            cl.argument(arguments[i]);
+
+        bp::stream_behavior const behaviors[] = {
+                bp::close_stream, bp::inherit_stream, bp::redirect_stream
+            };
+
+        bp::launcher l;
+        if (custom_environment_)
+        {
+            l.clear_environment();
+
+            std::map<std::string, std::string>::const_iterator end
+                = environment_.end();
+            for (std::map<std::string, std::string>::const_iterator it
+                    = environment_.begin(); it != end; ++it)
+                l.set_environment((*it).first, (*it).second);
+        }
+
+        l.set_stdin_behavior(behaviors[stdin_behavior]);
+        l.set_stdout_behavior(behaviors[stdout_behavior]);
+        l.set_stderr_behavior(behaviors[stderr_behavior]);
+
+        if (close_stream != stdout_behavior && close_stream == stderr_behavior)
+            l.set_merge_out_err(true);
+
+        return child_process(boost::shared_ptr<child_process::impl>(
+            new child_process::impl(l.start(cl))));
+    }
+
+#else // !defined(BOOST_WINDOWS)
+
+    std::string process_launcher::find_executable(
+            std::string const & command) const
+    {
+        if (std::string::npos != command.find('/'))
+            return command;
+
+        boost::mutex::scoped_lock lock(executables_mtx_);
+
+        std::map<std::string, std::string>::const_iterator cached
+            = executables_.find(command);
+        if (executables_.end() != cached)
+            return (*cached).second;
+
+        std::string path = search_path_;
+        if (path.empty())
+        {
+            char const * env_path = std::getenv("PATH");
+            path = env_path ? env_path : "/bin:/usr/bin";
+        }
+
+        std::string::size_type begin = 0;
+        for (;;)
+        {
+            std::string::size_type end = path.find(':', begin);
+            std::string dir = path.substr(begin,
+                std::string::npos == end ? end : end - begin);
+            if (dir.empty())
+                dir = ".";
+
+            std::string const candidate = dir + "/" + command;
+            if (0 == ::access(candidate.c_str(), X_OK))
+                return executables_[command] = candidate;
+
+            if (std::string::npos == end)
+                break;
+            begin = end + 1;
+        }
+
+        throw std::runtime_error("Couldn't find executable '" + command
+            + "' in " + path + ".");
+    }
+
+    child_process process_launcher::start(std::string const & command,
+            std::vector<std::string> const & arguments,
+            stream_behavior stdin_behavior,
+            stream_behavior stdout_behavior,
+            stream_behavior stderr_behavior) const
+    {
+        std::string const executable = find_executable(command);
+
+        std::vector<char *> argv;
+        argv.reserve(arguments.size() + 2);
+        argv.push_back(const_cast<char *>(command.c_str()));
+        for (std::size_t i = 0; i < arguments.size(); ++i)
+            argv.push_back(const_cast<char *>(arguments[i].c_str()));
+        argv.push_back(0);
+
+        int in[2] = { -1, -1 };
+        int out[2] = { -1, -1 };
+
+        char dev_null[] = "/dev/null";
+
+        try
+        {
+            file_actions fa;
+            posix_spawn_file_actions_t & actions = fa.actions;
+
+            if (redirect_stream == stdin_behavior)
+            {
+                make_pipe(in);
+                posix_spawn_file_actions_adddup2(&actions, in[0], 0);
+            }
+            else if (close_stream == stdin_behavior)
+                posix_spawn_file_actions_addopen(&actions, 0, dev_null,
+                    O_RDONLY, 0);
+
+            if (redirect_stream == stdout_behavior)
+            {
+                make_pipe(out);
+                posix_spawn_file_actions_adddup2(&actions, out[1], 1);
+            }
+            else if (close_stream == stdout_behavior)
+                posix_spawn_file_actions_addopen(&actions, 1, dev_null,
+                    O_WRONLY, 0);
+
+            if (redirect_stream == stdout_behavior
+                    && inherit_stream != stderr_behavior)
+                posix_spawn_file_actions_adddup2(&actions, out[1], 2);
+            else if (close_stream == stderr_behavior)
+                posix_spawn_file_actions_addopen(&actions, 2, dev_null,
+                    O_WRONLY, 0);
+
+            pid_t pid;
+            int result = ::posix_spawn(&pid, executable.c_str(), &actions, 0,
+                &argv[0], custom_environment_
+                    ? const_cast<char * const *>(&envp_[0])
+                    : environ);
+
+            // The child's ends.
+            close_fd(in[0]);
+            close_fd(out[1]);
+
+            if (0 != result)
+                throw std::runtime_error("Failed to start " + executable
+                    + ": " + std::strerror(result));
+
+            return child_process(boost::shared_ptr<child_process::impl>(
+                new child_process::impl(pid, in[1], out[0])));
+        }
+        catch (...)
+        {
+            for (int i = 0; i < 2; ++i)
+            {
+                close_fd(in[i]);
+                close_fd(out[i]);
+            }
+            throw;
+        }
+    }
+
+#endif // !defined(BOOST_WINDOWS)
+
+}}} // namespace saga::adaptors::condor
@@ -0,0 +1,130 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_PROCESS_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_PROCESS_HPP
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    struct process_status
+    {
+        process_status()
+            : exited_(false)
+            , exit_status_(-1)
+        {
+        }
+
+        process_status(bool exited, int exit_status)
+            : exited_(exited)
+            , exit_status_(exit_status)
+        {
+        }
+
+        // False if the process was killed by a signal.
+        bool exited() const
+        {
+            return exited_;
+        }
+
+        int exit_status() const
+        {
+            return exit_status_;
+        }
+
+    private:
+        bool exited_;
+        int exit_status_;
+    };
+
+    //  A running Condor command. Copies share the same process.
+    struct child_process
+    {
+        // Valid for redirected streams only.
+        std::ostream & get_stdin();
+        std::istream & get_stdout();
+
+        // Signals end of input.
+        void close_stdin();
+
+        process_status wait();
+
+        // Kills the process, unless it has been waited for. Safe to call
+        // while another thread is in wait().
+        void kill();
+
+        struct impl;
+
+        explicit child_process(boost::shared_ptr<impl> const & i)
+            : impl_(i)
+        {
+        }
+
+    private:
+        boost::shared_ptr<impl> impl_;
+    };
+
+    //  Starts Condor commands.
+    //
+    //  On POSIX systems, commands are started with posix_spawn, which
+    //  implementations (e.g., glibc's) carry out with vfork semantics,
+    //  instead of copying the page tables of our, possibly large, process.
+    //  Per-call work is kept to a minimum: the environment block is built
+    //  once, as it's configured, and paths to executables are looked up
+    //  once per command.
+    struct process_launcher
+    {
+        enum stream_behavior
+        {
+            close_stream,       // Connected to /dev/null.
+            inherit_stream,
+            redirect_stream     // Connected to a pipe.
+        };
+
+        process_launcher();
+
+        // Directory where commands are found. Empty to search the PATH.
+        void set_search_path(std::string const & path);
+
+        // Commands get an empty environment, until variables are set.
+        void clear_environment();
+        void set_environment(std::string const & name,
+            std::string const & value);
+
+        //  Starts command with arguments. With stdout redirected, a closed
+        //  stderr is merged into stdout.
+        child_process start(std::string const & command,
+            std::vector<std::string> const & arguments,
+            stream_behavior stdin_behavior,
+            stream_behavior stdout_behavior,
+            stream_behavior stderr_behavior) const;
+
+    private:
+        std::string find_executable(std::string const & command) const;
+        void update_environment();
+
+        std::string search_path_;
+
+        // The inherited environment is used, unless this is set.
+        bool custom_environment_;
+        std::map<std::string, std::string> environment_;
+        std::vector<std::string> env_block_;
+        std::vector<char *> envp_;
+
+        mutable boost::mutex executables_mtx_;
+        mutable std::map<std::string, std::string> executables_;
+    };
+
+}}} // namespace saga::adaptors::condor
+
+#endif // include guard
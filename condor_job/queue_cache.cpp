@@ -0,0 +1,190 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "queue_cache.hpp"
+#include "clock.hpp"
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/regex.hpp>
+
+#include <algorithm>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    queue_cache::queue_cache(fetch_function const & fetch, config const & c)
+        : fetch_(fetch)
+        , config_(c)
+        , taken_(-1.)
+        , fetching_(false)
+    {
+    }
+
+    bool queue_cache::get_job(std::string const & job_id,
+            std::string & classads, double & taken, double not_before)
+    {
+        if (!(config_.ttl > 0.))
+            return false;
+
+        std::string::size_type const dot = job_id.find('.');
+        std::string const cluster_id = job_id.substr(0, dot);
+
+        boost::mutex::scoped_lock lock(mtx_);
+        refresh(lock, not_before);
+
+        cluster_map::const_iterator cluster = clusters_.find(cluster_id);
+        if (clusters_.end() == cluster)
+            return false;
+
+        process_map const & processes = (*cluster).second;
+        if (std::string::npos != dot)
+        {
+            std::size_t proc;
+            try
+            {
+                proc = boost::lexical_cast<std::size_t>(job_id.substr(dot + 1));
+            }
+            catch (boost::bad_lexical_cast const &)
+            {
+                return false;
+            }
+
+            process_map::const_iterator it = processes.find(proc);
+            if (processes.end() == it)
+                return false;
+
+            classads = (*it).second;
+            taken = taken_;
+            return true;
+        }
+
+        classads.clear();
+        process_map::const_iterator end = processes.end();
+        for (process_map::const_iterator it = processes.begin(); it != end;
+                ++it)
+            classads += (*it).second + "\n";
+
+        taken = taken_;
+        return true;
+    }
+
+    void queue_cache::invalidate(std::string const & cluster_id)
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+
+        clusters_.erase(cluster_id);
+
+        if (fetching_)
+            invalidated_.insert(cluster_id);
+    }
+
+    void queue_cache::refresh(boost::mutex::scoped_lock & lock,
+            double not_before)
+    {
+        if (fetching_)
+        {
+            // Someone else is taking a snapshot, use that unless it started
+            // too early.
+            while (fetching_)
+                fetched_.wait(lock);
+            if (taken_ >= not_before)
+                return;
+        }
+
+        double const start = detail::now();
+        if (taken_ >= 0. && taken_ >= not_before
+                && start - taken_ < config_.ttl)
+            return;
+
+        fetching_ = true;
+        invalidated_.clear();
+
+        cluster_map clusters;
+        lock.unlock();
+
+        try
+        {
+            fetch_(boost::bind(&queue_cache::add, boost::ref(clusters), _1));
+        }
+        catch (...)
+        {
+            lock.lock();
+            fetching_ = false;
+            fetched_.notify_all();
+            throw;
+        }
+
+        lock.lock();
+
+        std::set<std::string>::const_iterator end = invalidated_.end();
+        for (std::set<std::string>::const_iterator it = invalidated_.begin();
+                it != end; ++it)
+            clusters.erase(*it);
+
+        clusters_.swap(clusters);
+        taken_ = start;
+
+        fetching_ = false;
+        fetched_.notify_all();
+    }
+
+    void queue_cache::add(cluster_map & clusters,
+            std::string const & classad)
+    {
+        // Sorted, for lookups.
+        static char const * const kept[] = {
+            "ClusterId", "Deferral_Time", "Error", "Executable", "ExitCode",
+            "Input", "JobStatus", "Notify_User", "Output", "ProcId",
+            "Remote_InitialDir", "Universe", "UserLog", "UserLogUseXML"
+        };
+        static char const * const * const kept_end
+            = kept + sizeof(kept) / sizeof(*kept);
+
+        static boost::regex const cluster_re(
+            "<a\\s+n=\"ClusterId\">\\s*<i>(\\d+)</i>");
+        static boost::regex const proc_re(
+            "<a\\s+n=\"ProcId\">\\s*<i>(\\d+)</i>");
+
+        boost::smatch cluster, proc;
+        if (!boost::regex_search(classad, cluster, cluster_re)
+                || !boost::regex_search(classad, proc, proc_re))
+            return;
+
+        std::size_t proc_id;
+        try
+        {
+            proc_id = boost::lexical_cast<std::size_t>(proc.str(1));
+        }
+        catch (boost::bad_lexical_cast const &)
+        {
+            return;
+        }
+
+        // <a n="Name">...</a> elements of the attributes we keep, as is.
+        std::string projection = "<c>\n";
+
+        std::string key;
+        std::string::size_type pos = 0;
+        while (std::string::npos != (pos = classad.find("<a n=\"", pos)))
+        {
+            std::string::size_type const name = pos + 6;
+            std::string::size_type const name_end = classad.find('"', name);
+            std::string::size_type const end = classad.find("</a>", name);
+            if (std::string::npos == name_end || std::string::npos == end)
+                break;
+
+            key.assign(classad, name, name_end - name);
+            if (std::binary_search(kept, kept_end, key))
+                projection.append("    ").append(classad, pos, end + 4 - pos)
+                    .append("\n");
+
+            pos = end + 4;
+        }
+
+        projection += "</c>";
+        clusters[cluster.str(1)][proc_id].swap(projection);
+    }
+
+}}} // namespace saga::adaptors::condor
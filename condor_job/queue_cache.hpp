@@ -0,0 +1,94 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_QUEUE_CACHE_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_QUEUE_CACHE_HPP
+
+#include "classad_reader.hpp"
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    //  Snapshot of the job queue of a schedd, taken with a single
+    //  `condor_q -xml` over all jobs, and shared by reconnecting jobs.
+    //  Reconnecting many jobs at once costs one condor_q, instead of one per
+    //  job.
+    //
+    //  The snapshot is retaken once it is older than ttl seconds. Clusters
+    //  the log processor reports events for are dropped from it, and looked
+    //  up directly by callers, until the next snapshot.
+    //
+    //  Only the attributes reconnecting reads are kept of each job's
+    //  ClassAd: IDs, status, exit code, job log and those mapped onto the
+    //  job description.
+    struct queue_cache
+        : boost::noncopyable
+    {
+        struct config
+        {
+            config()
+                : ttl(30.)
+            {
+            }
+
+            // Seconds. 0 disables caching.
+            double ttl;
+        };
+
+        //  Runs condor_q -xml for all jobs, handing each job's ClassAd to the
+        //  callback, as it is read.
+        typedef boost::function<void(classad_reader::callback const &)>
+            fetch_function;
+
+        queue_cache(fetch_function const & fetch, config const & c = config());
+
+        //  ClassAds (as XML) of job_id: one for "Cluster.Proc", every
+        //  process' for "Cluster". Snapshots taken before not_before (see
+        //  detail::now()) are retaken. Returns false if the job isn't in
+        //  the snapshot, otherwise sets taken to the time the snapshot was
+        //  taken. Throws what fetch throws.
+        bool get_job(std::string const & job_id, std::string & classads,
+            double & taken, double not_before = -1.);
+
+        //  Drops cluster_id from the snapshot, as its state changes, or it
+        //  is submitted.
+        void invalidate(std::string const & cluster_id);
+
+    private:
+        typedef std::map<std::size_t, std::string> process_map;
+        typedef std::map<std::string, process_map> cluster_map;
+
+        //  Takes a snapshot if the current one is older than ttl, or was
+        //  taken before not_before. Called with the lock held.
+        void refresh(boost::mutex::scoped_lock & lock, double not_before);
+
+        // Adds a job's ClassAd to clusters, keeping the attributes we read.
+        static void add(cluster_map & clusters, std::string const & classad);
+
+        fetch_function const fetch_;
+        config const config_;
+
+        boost::mutex mtx_;
+        cluster_map clusters_;
+        double taken_;
+
+        // One snapshot at a time; clusters invalidated meanwhile are dropped
+        // from it.
+        bool fetching_;
+        std::set<std::string> invalidated_;
+        boost::condition fetched_;
+    };
+
+}}} // namespace saga::adaptors::condor
+
+#endif // include guard
@@ -7,9 +7,11 @@
 #define SAGA_ADAPTORS_CONDOR_JOB_SHARED_JOB_DATA_HPP
 
 #include "pool_data.hpp"
+#include "proc_table.hpp"
 
 #include <saga/saga/packages/job/job.hpp>
 
+#include <boost/detail/atomic_count.hpp>
 #include <boost/thread.hpp>
 #include <boost/thread/condition.hpp>
 
@@ -19,6 +21,9 @@
 
 namespace saga { namespace adaptors { namespace condor {
 
+    struct dag_workflow;
+    struct job_bundle;
+
     struct shared_job_data
         : boost::enable_shared_from_this<shared_job_data>
     {
@@ -26,6 +31,29 @@ namespace saga { namespace adaptors { namespace condor {
         typedef boost::recursive_mutex::scoped_lock scoped_lock;
         typedef std::map<std::string, std::string> attribute_map;
 
+        shared_job_data()
+            : state(saga::job::New)
+            , dag_post_script(false)
+            , queued(false)
+            , flow_controlled(false)
+            , idle_procs(0)
+            , completion_reported(false)
+        {
+            ++live_count_;
+        }
+
+        ~shared_job_data()
+        {
+            --live_count_;
+        }
+
+        // Number of shared_job_data instances alive in the process, whether
+        // registered or not.
+        static std::size_t get_live_count()
+        {
+            return std::size_t(long(live_count_));
+        }
+
         void register_job()
         {
             pool_->get_registry()->register_job(shared_from_this());
@@ -42,13 +70,59 @@ namespace saga { namespace adaptors { namespace condor {
 
         attribute_map attributes;
 
+        // Per-process states, for clusters with more than one process.
+        proc_table procs;
+
         std::string full_job_id;
         std::string cluster_id;
 
         std::set<job_cpi_impl *> instances;
 
+        // Set on Condor jobs running a bundle of tasks.
+        boost::shared_ptr<job_bundle> bundle;
+
+        // Tasks in a bundle are identified as "Cluster:Task".
+        bool is_bundled_task() const
+        {
+            return std::string::npos != cluster_id.find(':');
+        }
+
+        // Set on DAGMan jobs.
+        boost::shared_ptr<dag_workflow> dag;
+
+        // DAG nodes with a POST script are finished once the script
+        // terminates.
+        bool dag_post_script;
+
+        // Set while the job waits in the admission controller's queue.
+        bool queued;
+
+        // Jobs submitted under admission control report the number of
+        // their idle processes, idle_procs, back to the controller.
+        bool flow_controlled;
+        std::size_t idle_procs;
+
+        // Whether the job, or process proc if not negative, is finished.
+        bool is_state_final(int proc = -1) const
+        {
+            saga::job::state s = proc < 0
+                ? state
+                : proc_table::to_saga_state(procs.get(proc));
+            return saga::job::Done == s
+                || saga::job::Canceled == s
+                || saga::job::Failed == s;
+        }
+
+        // Set once the job's final state is pushed to the pool's
+        // completion_queue.
+        bool completion_reported;
+
         boost::condition state_change;
         mutex state_change_mtx;
+
+    private:
+        // Defined in job_registry.cpp.
+        static boost::detail::atomic_count live_count_;
     };
 
     inline std::string const & get_cluster_id(
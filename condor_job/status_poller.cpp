@@ -0,0 +1,249 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "status_poller.hpp"
+#include "clock.hpp"
+#include "condor_job_adaptor.hpp"
+#include "log_processor.hpp"
+#include "pool_data.hpp"
+#include "shared_job_data.hpp"
+
+#include <saga/saga-defs.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <iterator>
+#include <map>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    namespace {
+
+        // Cluster IDs passed to a single command.
+        std::size_t const max_clusters = 500;
+
+        //  Updates job, and its summary in registry, from the entries
+        //  reported for its cluster. Returns true if its state changed.
+        //  Called with the registry locked.
+        bool apply(job_registry & registry, shared_job_data & job,
+                std::vector<status_poller::entry> const & entries)
+        {
+            using saga::job::attributes::exitcode;
+
+            shared_job_data::scoped_lock lock(job.state_change_mtx);
+
+            if (entries.empty() || job.is_state_final())
+                return false;
+
+            bool changed = false;
+            saga::job::state state;
+
+            if (job.procs.size() > 1)
+            {
+                for (std::size_t i = 0; i < entries.size(); ++i)
+                {
+                    status_poller::entry const & e = entries[i];
+                    proc_table::proc_state const proc_state
+                        = proc_table::from_status(e.status);
+
+                    if (e.proc < job.procs.size()
+                            && job.procs.get(e.proc) == proc_state)
+                        continue;
+
+                    job.procs.set(e.proc, proc_state, e.exit_code);
+                    changed = true;
+                }
+
+                state = job.procs.get_aggregate_state();
+                if (job.procs.is_final())
+                    job.attributes[exitcode] = boost::lexical_cast<
+                        std::string>(job.procs.get_aggregate_exit_code());
+            }
+            else
+            {
+                status_poller::entry const & e = entries.front();
+                proc_table::proc_state const proc_state
+                    = proc_table::from_status(e.status);
+
+                state = proc_table::to_saga_state(proc_state);
+                if (proc_table::done == proc_state
+                        || proc_table::failed == proc_state)
+                    job.attributes[exitcode]
+                        = boost::lexical_cast<std::string>(e.exit_code);
+            }
+
+            if (state != job.state)
+            {
+                job.state = state;
+                changed = true;
+            }
+
+            if (changed)
+            {
+                log_processor::notify(job, -1);
+                registry.update_summary(job);
+            }
+
+            return changed;
+        }
+
+    } // namespace
+
+    status_poller::status_poller(job_adaptor const & adaptor, pool & p)
+        : adaptor_(adaptor)
+        , pool_(p)
+        , config_(adaptor.get_polling_config())
+        , woken_(false)
+        , stop_(false)
+        , thread_(boost::bind(&status_poller::poll_loop, this))
+    {
+    }
+
+    status_poller::~status_poller()
+    {
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+
+        thread_.join();
+    }
+
+    void status_poller::wake()
+    {
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+            woken_ = true;
+        }
+        wake_.notify_all();
+    }
+
+    void status_poller::poll_loop()
+    {
+        double interval = config_.min_interval;
+
+        boost::mutex::scoped_lock lock(mtx_);
+        while (!stop_)
+        {
+            boost::xtime const deadline = detail::make_deadline(interval);
+            while (!stop_ && !woken_)
+                if (!wake_.timed_wait(lock, deadline))
+                    break;
+
+            if (stop_)
+                break;
+
+            // New jobs may change soon.
+            if (woken_)
+                interval = config_.min_interval;
+            woken_ = false;
+
+            lock.unlock();
+
+            bool changed = false;
+            try
+            {
+                changed = poll();
+            }
+            catch (std::exception const & e)
+            {
+                SAGA_LOG_WARN(("Condor adaptor: Failed to poll job states "
+                    "on " + pool_.get_url() + ": " + e.what()).c_str());
+            }
+
+            lock.lock();
+
+            interval = changed ? config_.min_interval
+                : (std::min)(config_.max_interval, interval * 2);
+        }
+    }
+
+    bool status_poller::poll()
+    {
+        std::vector<boost::shared_ptr<shared_job_data> > jobs;
+        pool_.get_registry()->get_jobs(jobs);
+
+        typedef std::map<std::string, boost::shared_ptr<shared_job_data> >
+            cluster_map;
+        cluster_map clusters;
+
+        for (std::size_t i = 0; i < jobs.size(); ++i)
+        {
+            shared_job_data & job = *jobs[i];
+            shared_job_data::scoped_lock lock(job.state_change_mtx);
+
+            if (job.full_job_id.empty() || job.cluster_id.empty()
+                    || job.is_bundled_task() || job.is_state_final())
+                continue;
+
+            clusters[job.cluster_id] = jobs[i];
+        }
+
+        if (clusters.empty())
+            return false;
+
+        std::set<std::string> pending;
+        for (cluster_map::const_iterator it = clusters.begin();
+                it != clusters.end(); ++it)
+            pending.insert((*it).first);
+
+        std::vector<entry> entries;
+        std::set<std::string> seen;
+        query("condor_q", pending, entries, seen);
+
+        // Jobs that left the queue.
+        std::set<std::string> gone;
+        std::set_difference(pending.begin(), pending.end(),
+            seen.begin(), seen.end(), std::inserter(gone, gone.end()));
+        if (!gone.empty())
+            query("condor_history", gone, entries, seen);
+
+        std::map<std::string, std::vector<entry> > by_cluster;
+        for (std::size_t i = 0; i < entries.size(); ++i)
+            by_cluster[entries[i].cluster_id].push_back(entries[i]);
+
+        bool changed = false;
+        for (cluster_map::const_iterator it = clusters.begin();
+                it != clusters.end(); ++it)
+        {
+            // Locked before the job, as the log processor does.
+            synchronized<job_registry>::lock reg(pool_.get_registry());
+            if (apply(reg.get(), *(*it).second, by_cluster[(*it).first]))
+                changed = true;
+        }
+
+        return changed;
+    }
+
+    void status_poller::query(std::string const & command,
+            std::set<std::string> const & clusters,
+            std::vector<entry> & entries, std::set<std::string> & seen) const
+    {
+        std::set<std::string>::const_iterator it = clusters.begin();
+        while (clusters.end() != it)
+        {
+            std::vector<std::string> batch;
+            for (std::size_t i = 0; i < max_clusters && clusters.end() != it;
+                    ++i, ++it)
+                batch.push_back(*it);
+
+            std::istringstream out(adaptor_.run_condor_query(command,
+                get_arguments(batch)).output);
+
+            for (std::string line; std::getline(out, line); )
+            {
+                entry e;
+                if (parse_line(line, e) && clusters.count(e.cluster_id))
+                {
+                    entries.push_back(e);
+                    seen.insert(e.cluster_id);
+                }
+            }
+        }
+    }
+
+}}} // namespace saga::adaptors::condor
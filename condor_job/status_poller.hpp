@@ -0,0 +1,143 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_STATUS_POLLER_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_STATUS_POLLER_HPP
+
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    class job_adaptor;
+    struct pool;
+
+    //  Tracks the jobs of a pool without a job log the adaptor can read
+    //  (e.g., jobs reconnected to, that don't log in XML), by polling
+    //  Condor.
+    //
+    //  Each round queries all unfinished jobs in the pool's registry with a
+    //  single condor_q, and jobs that left the queue with condor_history.
+    //  Rounds are min_interval seconds apart while job states keep
+    //  changing, backing off to max_interval while they don't.
+    struct status_poller
+    {
+        struct config
+        {
+            config()
+                : min_interval(5.)
+                , max_interval(60.)
+            {
+            }
+
+            // Seconds
+            double min_interval;
+            double max_interval;
+        };
+
+        //  One line of `-af ClusterId ProcId JobStatus ExitCode` output.
+        struct entry
+        {
+            entry()
+                : proc(0)
+                , status(0)
+                , exit_code(0)
+            {
+            }
+
+            std::string cluster_id;
+            std::size_t proc;
+            int status;
+            int exit_code;
+        };
+
+        //  Arguments to condor_q and condor_history, for the given clusters.
+        //  They are selected with a constraint, as -af takes the arguments
+        //  following it as attributes.
+        static std::vector<std::string> get_arguments(
+            std::vector<std::string> const & clusters)
+        {
+            std::string constraint;
+            for (std::size_t i = 0; i < clusters.size(); ++i)
+            {
+                if (!constraint.empty())
+                    constraint += " || ";
+                constraint += "ClusterId == " + clusters[i];
+            }
+
+            std::vector<std::string> args;
+            args.push_back("-constraint");
+            args.push_back(constraint);
+            args.push_back("-af");
+            args.push_back("ClusterId");
+            args.push_back("ProcId");
+            args.push_back("JobStatus");
+            args.push_back("ExitCode");
+            return args;
+        }
+
+        //  Parses line into e. ExitCode is undefined, and taken as 0, until
+        //  the job completes.
+        static bool parse_line(std::string const & line, entry & e)
+        {
+            std::istringstream is(line);
+
+            std::string exit_code;
+            if (!(is >> e.cluster_id >> e.proc >> e.status >> exit_code))
+                return false;
+
+            std::istringstream code(exit_code);
+            if (!(code >> e.exit_code))
+                e.exit_code = 0;
+
+            return !e.cluster_id.empty()
+                && e.cluster_id.end() == std::find_if(e.cluster_id.begin(),
+                    e.cluster_id.end(), is_not_digit);
+        }
+
+        status_poller(job_adaptor const & adaptor, pool & p);
+        ~status_poller();
+
+        // Starts a round now, e.g., as jobs are added.
+        void wake();
+
+    private:
+        static bool is_not_digit(char c)
+        {
+            return c < '0' || c > '9';
+        }
+
+        void poll_loop();
+
+        //  Runs one round. Returns true if the state of any job changed.
+        bool poll();
+
+        //  Runs command over clusters, returning entries reported and the
+        //  clusters they belong to.
+        void query(std::string const & command,
+            std::set<std::string> const & clusters,
+            std::vector<entry> & entries, std::set<std::string> & seen) const;
+
+        job_adaptor const & adaptor_;
+        pool & pool_;
+        config const config_;
+
+        boost::mutex mtx_;
+        boost::condition wake_;
+        bool woken_;
+        bool stop_;
+
+        boost::thread thread_;
+    };
+
+}}} // namespace saga::adaptors::condor
+
+#endif // include guard
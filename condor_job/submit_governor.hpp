@@ -0,0 +1,188 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_SUBMIT_GOVERNOR_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_SUBMIT_GOVERNOR_HPP
+
+#include "clock.hpp"
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    //  Paces condor_submit invocations on a pool to what the schedd can
+    //  absorb.
+    //
+    //  Submissions are spaced out to a rate that is adjusted AIMD-style:
+    //  it grows by a fixed step after each fast submission, and is halved
+    //  whenever its (smoothed) latency exceeds the target or condor_submit
+    //  fails transiently, like the schedd being busy or unreachable. Those
+    //  failures are retried a limited number of times, with exponential
+    //  backoff and random jitter. Backing off holds all submissions to the
+    //  pool, not just the failed one. Other failures, e.g. of an invalid
+    //  description, are not retried and leave the pace alone.
+    struct submit_governor
+    {
+        struct config
+        {
+            config()
+                : enabled(true)
+                , max_rate(10.)
+                , min_rate(.1)
+                , rate_increase(1.)
+                , target_latency(5.)
+                , max_retries(5)
+                , backoff(1.)
+                , max_backoff(60.)
+            {
+            }
+
+            bool enabled;
+
+            // Submissions per second
+            double max_rate;
+            double min_rate;
+            double rate_increase;
+
+            // Seconds
+            double target_latency;
+
+            unsigned max_retries;
+
+            // Seconds, before jitter
+            double backoff;
+            double max_backoff;
+        };
+
+        explicit submit_governor(config const & c = config())
+            : config_(c)
+            , rate_(c.max_rate)
+            , latency_(0.)
+            , next_(0.)
+        {
+        }
+
+        // Blocks until the next submission is due.
+        void wait_turn()
+        {
+            if (!config_.enabled)
+                return;
+
+            double due;
+            {
+                boost::mutex::scoped_lock lock(mtx_);
+
+                due = (std::max)(next_, detail::now());
+                next_ = due + 1. / rate_;
+            }
+
+            boost::thread::sleep(detail::to_xtime(due));
+        }
+
+        // Reports a successful submission that took latency seconds.
+        void succeeded(double latency)
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+
+            // Exponentially weighted moving average
+            latency_ = (0. == latency_)
+                ? latency
+                : .8 * latency_ + .2 * latency;
+
+            if (latency_ > config_.target_latency)
+                decrease_rate();
+            else
+                rate_ = (std::min)(config_.max_rate,
+                    rate_ + config_.rate_increase);
+        }
+
+        //  Reports failure of the attempt-th try (starting at 0) of a
+        //  submission, with error as the diagnostic. Returns the delay, in
+        //  seconds, before the submission is retried by wait_turn, or a
+        //  negative value if it should not be retried.
+        double failed(std::string const & error, unsigned attempt)
+        {
+            if (!is_transient(error))
+                return -1.;
+
+            boost::mutex::scoped_lock lock(mtx_);
+
+            decrease_rate();
+
+            if (!config_.enabled || attempt >= config_.max_retries)
+                return -1.;
+
+            double delay = config_.backoff;
+            for (unsigned i = 0; i < attempt && delay < config_.max_backoff;
+                    ++i)
+                delay *= 2.;
+            delay = (std::min)(delay, config_.max_backoff);
+
+            // Jitter, in [.5, 1.5), keeps failed submitters from retrying in
+            // lockstep.
+            delay *= .5 + std::rand() / (RAND_MAX + 1.);
+
+            next_ = (std::max)(next_, detail::now() + delay);
+            return delay;
+        }
+
+        double get_rate() const
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+            return rate_;
+        }
+
+        double get_latency() const
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+            return latency_;
+        }
+
+        //  Diagnostics of condor_submit failures worth retrying: the schedd
+        //  is busy, unreachable or timing out.
+        static bool is_transient(std::string const & error)
+        {
+            static char const * const patterns[] = {
+                    "Failed to connect",
+                    "Connection refused",
+                    "Connection timed out",
+                    "timed out",
+                    "Can't find address",
+                    "Failed to commit",
+                    "Too many",
+                    "busy",
+                    "temporarily unavailable"
+                };
+
+            for (std::size_t i = 0;
+                    i < sizeof(patterns) / sizeof(*patterns); ++i)
+                if (boost::icontains(error, patterns[i]))
+                    return true;
+
+            return false;
+        }
+
+    private:
+        void decrease_rate()
+        {
+            rate_ = (std::max)(config_.min_rate, rate_ / 2.);
+        }
+
+        config const config_;
+
+        mutable boost::mutex mtx_;
+        double rate_;
+        double latency_;
+        double next_;
+    };
+
+}}} // namespace saga::adaptors::condor
+
+#endif // include guard
@@ -0,0 +1,253 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "task_bundler.hpp"
+#include "clock.hpp"
+#include "condor_job_adaptor.hpp"
+#include "pool_data.hpp"
+#include "shared_job_data.hpp"
+#include "temporary.hpp"
+
+#include <saga/saga-defs.hpp>
+#include <saga/impl/exception.hpp>
+
+#include <sys/stat.h>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    namespace {
+
+        // Attributes describing what is run. These may differ between tasks
+        // in a bundle.
+        char const * const task_attributes[] = {
+                "executable",
+                "arguments",
+                "environment",
+                "remote_initialdir",
+                "output",
+                "error"
+            };
+
+        // Attributes that prevent a job from being bundled.
+        char const * const unbundleable_attributes[] = {
+                "input",
+                "transfer_input_files",
+                "transfer_output_files",
+                "transfer_output_remaps",
+                "deferral_time"
+            };
+
+        void write_wrapper(temporary_file const & file,
+                std::string const & script)
+        {
+            if (!write_temporary_file(file, script))
+                SAGA_ADAPTOR_THROW_NO_CONTEXT("Failed to write wrapper "
+                    "script for bundle of jobs: "
+                    + file.get_path().string(), saga::NoSuccess);
+
+            if (0 != ::fchmod(file.get_fd(), S_IRWXU))
+                SAGA_ADAPTOR_THROW_NO_CONTEXT("Failed to make wrapper script "
+                    "for bundle of jobs executable: "
+                    + file.get_path().string(), saga::NoSuccess);
+        }
+
+    } // namespace
+
+    // NOTE: Out-of-line, where temporary_file is a complete type.
+    job_bundle::job_bundle() {}
+    job_bundle::~job_bundle() {}
+
+    task_bundler::task_bundler(job_adaptor const & adaptor, pool & p)
+        : adaptor_(adaptor)
+        , pool_(p)
+        , config_(adaptor.get_bundling_config())
+    {
+    }
+
+    bool task_bundler::is_bundleable(::condor::job::description const & desc)
+    {
+        typedef ::condor::job::description::attributes_type attributes_type;
+        attributes_type const & attributes = desc.get_attributes();
+
+        for (std::size_t i = 0; i < sizeof(unbundleable_attributes)
+                / sizeof(*unbundleable_attributes); ++i)
+        {
+            attributes_type::const_iterator it
+                = attributes.find(unbundleable_attributes[i]);
+            if (attributes.end() != it && !it->second.empty())
+                return false;
+        }
+
+        return 1 == desc.get_process_count()
+            && desc.get_queue_items().empty();
+    }
+
+    task_bundler::task task_bundler::make_task(
+            saga::job::description const & jd,
+            boost::shared_ptr<shared_job_data> job)
+    {
+        using namespace saga::job::attributes;
+
+        task t;
+        t.executable = jd.get_attribute(description_executable);
+
+        if (jd.attribute_exists(description_arguments))
+            t.arguments = jd.get_vector_attribute(description_arguments);
+        if (jd.attribute_exists(description_environment))
+            t.environment = jd.get_vector_attribute(description_environment);
+        if (jd.attribute_exists(description_working_directory))
+            t.working_directory
+                = jd.get_attribute(description_working_directory);
+        if (jd.attribute_exists(description_output))
+            t.output = jd.get_attribute(description_output);
+        if (jd.attribute_exists(description_error))
+            t.error = jd.get_attribute(description_error);
+
+        t.job = job;
+        return t;
+    }
+
+    void task_bundler::submit(::condor::job::description const & desc,
+            task const & t)
+    {
+        // Bundles are keyed by the job attributes tasks have in common.
+        ::condor::job::description::attributes_type common
+            = desc.get_attributes();
+        for (std::size_t i = 0;
+                i < sizeof(task_attributes) / sizeof(*task_attributes); ++i)
+            common.erase(task_attributes[i]);
+
+        std::string key;
+        {
+            ::condor::job::description::attributes_type::const_iterator end
+                = common.end();
+            for (::condor::job::description::attributes_type::const_iterator
+                    it = common.begin(); it != end; ++it)
+                key += (*it).first + " = " + (*it).second + "\n";
+        }
+
+        boost::mutex::scoped_lock lock(mtx_);
+
+        shared_bundle & slot = pending_[key];
+        if (!slot)
+        {
+            slot.reset(new pending_bundle());
+            slot->key = key;
+            slot->desc = ::condor::job::description(common);
+
+            slot->deadline = detail::make_deadline(config_.max_delay);
+        }
+
+        shared_bundle b = slot;
+        b->tasks.push_back(t);
+
+        if (b->tasks.size() >= config_.max_tasks)
+            flush(b, lock);
+
+        while (!b->done)
+        {
+            if (b->flushing)
+                flushed_.wait(lock);
+            else if (!flushed_.timed_wait(lock, b->deadline)
+                    && !b->flushing && !b->done)
+                flush(b, lock);
+        }
+
+        if (!b->error.empty())
+            SAGA_ADAPTOR_THROW_NO_CONTEXT(b->error, saga::NoSuccess);
+    }
+
+    void task_bundler::flush(shared_bundle b, boost::mutex::scoped_lock & lock)
+    {
+        BOOST_ASSERT(!b->flushing && !b->done
+            && "Bundle of jobs submitted twice.");
+
+        b->flushing = true;
+
+        // Tasks queued from now on go into a new bundle.
+        bundle_map::iterator it = pending_.find(b->key);
+        if (pending_.end() != it && it->second == b)
+            pending_.erase(it);
+
+        lock.unlock();
+        try
+        {
+            submit_bundle(*b);
+        }
+        catch (saga::exception const & e)
+        {
+            b->error = e.what();
+        }
+        catch (std::exception const & e)
+        {
+            b->error = std::string("Problem submitting bundle of jobs: "
+                "(std::exception caught: ") + e.what() + ")";
+        }
+        lock.lock();
+
+        b->done = true;
+        flushed_.notify_all();
+    }
+
+    void task_bundler::submit_bundle(pending_bundle & b)
+    {
+        BOOST_ASSERT(!b.tasks.empty());
+
+        boost::shared_ptr<job_bundle> bundle(new job_bundle());
+
+        bundle->wrapper.reset(
+            open_temporary_file("saga-condor-bundle").release());
+        if (!bundle->wrapper)
+            SAGA_ADAPTOR_THROW_NO_CONTEXT("Failed to create wrapper script "
+                "for bundle of jobs.", saga::NoSuccess);
+
+        write_wrapper(*bundle->wrapper,
+            make_wrapper(b.tasks, config_.parallel));
+
+        std::string const wrapper = bundle->wrapper->get_path().string();
+        bundle->results = wrapper + ".out";
+
+        ::condor::job::description desc = b.desc;
+        desc.set_attribute("executable", wrapper);
+        desc.set_attribute("transfer_executable", "True");
+        desc.set_attribute("output", bundle->results);
+
+        std::string cluster_id, output;
+
+        // Returns with the registry locked, events are held back.
+        synchronized<job_registry>::lock lck
+            = adaptor_.submit(pool_, desc, cluster_id, output);
+        if (cluster_id.empty())
+            SAGA_ADAPTOR_THROW_NO_CONTEXT("Failed to determine Cluster ID for "
+                "bundle of jobs from the output of condor_submit (see below). "
+                "Won't be able to track the jobs.\n" + output,
+                saga::NoSuccess);
+
+        boost::shared_ptr<shared_job_data> bundle_job(new shared_job_data());
+        bundle_job->pool_ = b.tasks.front().job->pool_;
+        bundle_job->state = saga::job::Running;
+        bundle_job->cluster_id = cluster_id;
+        bundle_job->full_job_id = "[" + pool_.get_url() + "]-["
+            + cluster_id + "]";
+
+        for (std::size_t i = 0; i < b.tasks.size(); ++i)
+        {
+            boost::shared_ptr<shared_job_data> const & job = b.tasks[i].job;
+
+            shared_job_data::scoped_lock lock(job->state_change_mtx);
+            job->state = saga::job::Running;
+            job->cluster_id = get_task_id(cluster_id, i);
+            job->full_job_id = "[" + pool_.get_url() + "]-["
+                + job->cluster_id + "]";
+
+            bundle->tasks.push_back(job);
+            lck->register_job(job);
+        }
+
+        bundle_job->bundle = bundle;
+        lck->register_job(bundle_job);
+    }
+
+}}} // namespace saga::adaptors::condor
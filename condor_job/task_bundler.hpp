@@ -0,0 +1,258 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_TASK_BUNDLER_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_TASK_BUNDLER_HPP
+
+#include "description.hpp"
+
+#include <saga/saga/packages/job/job_description.hpp>
+
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+
+#include <istream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace saga { namespace adaptors { namespace condor {
+
+    class job_adaptor;
+    struct pool;
+    struct shared_job_data;
+    struct temporary_file;
+
+    //  A Condor job running a bundle of tasks. Attached to the bundle's
+    //  shared_job_data, for the log processor to fan out state changes to the
+    //  individual tasks.
+    struct job_bundle
+    {
+        job_bundle();
+        ~job_bundle();
+
+        std::vector<boost::shared_ptr<shared_job_data> > tasks;
+
+        // The generated wrapper script, removed once the bundle finishes.
+        boost::scoped_ptr<temporary_file> wrapper;
+
+        // Output of the wrapper script, holding the exit code of each task.
+        std::string results;
+    };
+
+    //  Packs short jobs into a single Condor job, saving on Condor's per-job
+    //  overhead (negotiation, shadow and starter startup).
+    //
+    //  Jobs whose descriptions differ only in what is run (executable,
+    //  arguments, environment, working directory and output redirection) are
+    //  compatible and may share a bundle. The bundle runs a generated wrapper
+    //  script that executes the tasks and reports their exit codes, which the
+    //  log processor fans out to the individual jobs once the bundle
+    //  terminates.
+    //
+    //  Bundled tasks are run on the execute machine as is: executables are
+    //  not transferred and must be available there.
+    struct task_bundler
+    {
+        struct config
+        {
+            config()
+                : enabled(false)
+                , max_tasks(100)
+                , max_delay(2)
+                , parallel(1)
+            {
+            }
+
+            bool enabled;
+
+            // Bundles are submitted once they hold max_tasks tasks, or
+            // max_delay seconds after their first task was queued.
+            std::size_t max_tasks;
+            unsigned max_delay;
+
+            // Number of tasks run concurrently inside a bundle.
+            std::size_t parallel;
+        };
+
+        struct task
+        {
+            std::string executable;
+            std::vector<std::string> arguments;
+            std::vector<std::string> environment;
+            std::string working_directory;
+            std::string output;
+            std::string error;
+
+            boost::shared_ptr<shared_job_data> job;
+        };
+
+        task_bundler(job_adaptor const & adaptor, pool & p);
+
+        //  Jobs with input redirection, file transfers, deferred start or
+        //  multiple processes are not bundled.
+        static bool is_bundleable(::condor::job::description const & desc);
+
+        static task make_task(saga::job::description const & jd,
+            boost::shared_ptr<shared_job_data> job);
+
+        //  Generates a shell script running tasks, parallel at a time, and
+        //  reporting the exit code of each on standard output as
+        //  "SAGA-TASK <index> <exit code>".
+        static std::string make_wrapper(std::vector<task> const & tasks,
+            std::size_t parallel);
+
+        //  Reads the output of the wrapper script. Sets exit_codes[i] and
+        //  reported[i] for each task i reported, ignoring other lines and
+        //  tasks beyond the size of the vectors.
+        static void read_results(std::istream & results,
+            std::vector<int> & exit_codes, std::vector<bool> & reported);
+
+        // Job ID of task index in the bundle submitted as cluster_id.
+        static std::string get_task_id(std::string const & cluster_id,
+            std::size_t index)
+        {
+            return cluster_id + ":" + boost::lexical_cast<std::string>(index);
+        }
+
+        //  Queues task for submission in a bundle with compatible tasks.
+        //  Blocks until the bundle has been submitted, setting up the task's
+        //  job data. Throws if the bundle couldn't be submitted.
+        void submit(::condor::job::description const & desc, task const & t);
+
+    private:
+        // Quotes str for the shell.
+        static std::string quote(std::string str)
+        {
+            boost::replace_all(str, "'", "'\\''");
+            return "'" + str + "'";
+        }
+
+        struct pending_bundle
+        {
+            pending_bundle()
+                : flushing(false)
+                , done(false)
+            {
+            }
+
+            std::string key;
+            ::condor::job::description desc;
+            std::vector<task> tasks;
+            boost::xtime deadline;
+
+            bool flushing;
+            bool done;
+            std::string error;
+        };
+
+        typedef boost::shared_ptr<pending_bundle> shared_bundle;
+        typedef std::map<std::string, shared_bundle> bundle_map;
+
+        // Submits bundle b. Called with mtx_ held, through lock.
+        void flush(shared_bundle b, boost::mutex::scoped_lock & lock);
+        void submit_bundle(pending_bundle & b);
+
+        job_adaptor const & adaptor_;
+        pool & pool_;
+        config const config_;
+
+        boost::mutex mtx_;
+        boost::condition flushed_;
+        bundle_map pending_;
+    };
+
+    inline std::string task_bundler::make_wrapper(
+            std::vector<task> const & tasks, std::size_t parallel)
+    {
+        std::string script =
+            "#!/bin/sh\n"
+            "# Generated by the SAGA Condor adaptor, for a bundle of "
+            + boost::lexical_cast<std::string>(tasks.size()) + " tasks.\n"
+            "\n";
+
+        for (std::size_t i = 0; i < tasks.size(); ++i)
+        {
+            task const & t = tasks[i];
+
+            std::string command = "(";
+            if (!t.working_directory.empty())
+                command += " cd " + quote(t.working_directory)
+                    + " || exit 127;";
+
+            command += " exec";
+            if (!t.environment.empty())
+            {
+                command += " env";
+
+                std::vector<std::string>::const_iterator end
+                    = t.environment.end();
+                for (std::vector<std::string>::const_iterator it
+                        = t.environment.begin(); it != end; ++it)
+                    command += " " + quote(*it);
+            }
+
+            command += " " + quote(t.executable);
+
+            {
+                std::vector<std::string>::const_iterator end
+                    = t.arguments.end();
+                for (std::vector<std::string>::const_iterator it
+                        = t.arguments.begin(); it != end; ++it)
+                    command += " " + quote(*it);
+            }
+
+            // Standard output of the wrapper is reserved for results.
+            command += " < /dev/null > " + (t.output.empty()
+                ? std::string("/dev/null") : quote(t.output));
+            if (!t.error.empty())
+                command += " 2> " + quote(t.error);
+
+            command += " ); echo \"SAGA-TASK "
+                + boost::lexical_cast<std::string>(i) + " $?\"";
+
+            if (parallel > 1)
+            {
+                script += "{ " + command + "; } &\n";
+                if (0 == (i + 1) % parallel)
+                    script += "wait\n";
+            }
+            else
+                script += command + "\n";
+        }
+
+        script += "wait\n";
+        return script;
+    }
+
+    inline void task_bundler::read_results(std::istream & results,
+            std::vector<int> & exit_codes, std::vector<bool> & reported)
+    {
+        std::string line;
+        while (std::getline(results, line))
+        {
+            std::istringstream record(line);
+            std::string tag;
+            std::size_t task;
+            int exit_code;
+
+            if (record >> tag >> task >> exit_code
+                    && "SAGA-TASK" == tag && task < exit_codes.size()
+                    && task < reported.size())
+            {
+                exit_codes[task] = exit_code;
+                reported[task] = true;
+            }
+        }
+    }
+
+}}} // namespace saga::adaptors::condor
+
+#endif // include guard
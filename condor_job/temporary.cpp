@@ -11,6 +11,8 @@
 #include <saga/saga/adaptors/utils/filesystem.hpp>
 #include <boost/scoped_array.hpp>
 
+#include <cerrno>
+
 namespace saga { namespace adaptors { namespace condor {
 
     // FIXME: On Windows, we're using both MAX_PATH and _MAX_PATH. Is this
@@ -123,5 +125,35 @@ namespace saga { namespace adaptors { namespace condor {
         return result;
     }
 
+    bool write_temporary_file(temporary_file const & file,
+            std::string const & content)
+    {
+        char const * data = content.data();
+        std::size_t size = content.size();
+
+        while (size)
+        {
+#if defined(BOOST_WINDOWS)
+            DWORD n = 0;
+            if (!WriteFile(file.get_fd(), data, DWORD(size), &n, NULL))
+                return false;
+#else
+            ssize_t n = ::write(file.get_fd(), data, size);
+            if (n < 0)
+            {
+                if (EINTR == errno)
+                    continue;
+
+                return false;
+            }
+#endif
+
+            data += n;
+            size -= n;
+        }
+
+        return true;
+    }
+
 }}} // namespace saga::adaptors::condor
 
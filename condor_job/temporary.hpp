@@ -11,6 +11,7 @@
 #include <saga/saga/adaptors/utils/filesystem.hpp>
 
 #include <memory>
+#include <string>
 
 #include <unistd.h>
 #if defined(BOOST_WINDOWS)
@@ -95,6 +96,10 @@ namespace saga { namespace adaptors { namespace condor {
     std::auto_ptr<temporary_file> open_temporary_file(
             boost::filesystem::path template_ = boost::filesystem::path());
 
+    // Writes content to file. Returns false on failure.
+    bool write_temporary_file(temporary_file const & file,
+            std::string const & content);
+
 }}} // namespace saga::adaptors::condor
 
 #endif // include guard
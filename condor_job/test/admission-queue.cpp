@@ -0,0 +1,114 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "../job_registry.cpp"
+#include "../admission_controller.hpp"
+
+#include "test_helpers.hpp"
+
+#include <iostream>
+
+using saga::adaptors::condor::admission_queue;
+using saga::adaptors::condor::shared_job_data;
+using saga::adaptors::condor::test::report_checks;
+
+admission_queue::entry make_entry(std::size_t count)
+{
+    admission_queue::entry e;
+    e.job.reset(new shared_job_data);
+    e.count = count;
+    return e;
+}
+
+int main()
+{
+    // Jobs are admitted while there's room for them
+    {
+        admission_queue queue(4);
+
+        CHECK(queue.admit(3));
+        CHECK(queue.admit(1));
+        CHECK(!queue.admit(1));
+        CHECK(4 == queue.get_idle_count());
+
+        queue.idle_changed(-2);
+        CHECK(2 == queue.get_idle_count());
+        CHECK(queue.admit(2));
+
+        // Idle counts don't go negative.
+        queue.idle_changed(-10);
+        CHECK(0 == queue.get_idle_count());
+    }
+
+    // A cluster larger than the limit waits for the pool to drain
+    {
+        admission_queue queue(4);
+
+        CHECK(queue.admit(1));
+
+        admission_queue::entry e;
+        queue.push(make_entry(10), 0);
+        CHECK(!queue.pop(e));
+        CHECK(!queue.admit(1));
+
+        queue.idle_changed(-1);
+        CHECK(queue.pop(e));
+        CHECK(10 == e.count);
+        CHECK(10 == queue.get_idle_count());
+        CHECK(0 == queue.size());
+    }
+
+    // Highest priority first, then first come, first served
+    {
+        admission_queue queue(1);
+
+        admission_queue::entry low = make_entry(1),
+            first = make_entry(1), second = make_entry(1),
+            high = make_entry(1);
+
+        queue.push(low, -5);
+        queue.push(first, 0);
+        queue.push(second, 0);
+        queue.push(high, 10);
+        CHECK(4 == queue.size());
+
+        admission_queue::entry e;
+        CHECK(queue.pop(e) && high.job == e.job);
+        CHECK(!queue.pop(e));
+
+        queue.idle_changed(-1);
+        CHECK(queue.pop(e) && first.job == e.job);
+        queue.idle_changed(-1);
+        CHECK(queue.pop(e) && second.job == e.job);
+        queue.idle_changed(-1);
+        CHECK(queue.pop(e) && low.job == e.job);
+        CHECK(0 == queue.size());
+    }
+
+    // Cancel while dispatching
+    {
+        admission_queue queue(1);
+
+        admission_queue::entry a = make_entry(1), b = make_entry(1);
+        queue.push(a, 0);
+        queue.push(b, 0);
+
+        admission_queue::entry e;
+        CHECK(queue.pop(e) && a.job == e.job);
+
+        // Popped, but not yet submitted.
+        CHECK(admission_queue::dispatching == queue.remove(a.job));
+
+        queue.done();
+        CHECK(admission_queue::not_queued == queue.remove(a.job));
+
+        CHECK(admission_queue::removed == queue.remove(b.job));
+        CHECK(admission_queue::not_queued == queue.remove(b.job));
+        CHECK(0 == queue.size());
+        CHECK(1 == queue.get_idle_count());
+    }
+
+    return report_checks();
+}
@@ -0,0 +1,203 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+//  Measures the cost of parsing ClassAds with find_and_parse, and of looking
+//  up their attributes, e.g.:
+//
+//      classad-benchmark [iterations]
+//
+//  For each kind of input, reports time and heap allocations per record, and
+//  throughput. Inputs are checked to parse as expected.
+
+#include "../classad.hpp"
+
+#include "log_generator.hpp"
+#include "test_helpers.hpp"
+
+#include <boost/lexical_cast.hpp>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+
+//  Heap allocations, counted by operator new.
+std::size_t allocations = 0;
+
+void * operator new(std::size_t size) throw (std::bad_alloc)
+{
+    ++allocations;
+    if (void * p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void * p) throw ()
+{
+    std::free(p);
+}
+
+using ::condor::job::classad;
+using saga::adaptors::condor::test::log_generator;
+using saga::adaptors::condor::test::now;
+using saga::adaptors::condor::test::report_checks;
+
+void report(std::string const & name, std::size_t count, std::size_t bytes,
+    double elapsed, std::size_t allocated)
+{
+    std::cout << "  " << std::left << std::setw(24) << name << std::right
+        << std::setw(10) << std::fixed << std::setprecision(0)
+        << 1e9 * elapsed / count << " ns" << std::setw(10)
+        << std::setprecision(1) << double(allocated) / count << " allocs";
+    if (bytes)
+        std::cout << std::setw(10) << bytes / elapsed / (1024 * 1024)
+            << " MB/s";
+    std::cout << "\n" << std::flush;
+}
+
+//  Parses input iterations times, a fresh classad each time. Returns false
+//  if any parse fails.
+bool parse(std::string const & name, std::string const & input,
+    std::size_t iterations, classad & result)
+{
+    bool ok = true;
+
+    std::size_t const allocated = allocations;
+    double const start = now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        classad c;
+        std::string::const_iterator first = input.begin();
+        ok = c.find_and_parse(first, input.end()) && ok;
+
+        if (i + 1 == iterations)
+            result = c;
+    }
+    double const elapsed = now() - start;
+
+    report(name, iterations, input.size() * iterations, elapsed,
+        allocations - allocated);
+    return ok;
+}
+
+//  A condor_q -xml job ad with attributes attributes, and strings with
+//  XML escapes if escaped.
+std::string make_job_ad(std::size_t attributes, bool escaped)
+{
+    std::string const text = escaped
+        ? "a &lt; b &amp;&amp; c &gt; &quot;d&quot;" : "a is less than b";
+
+    std::string ad = "<c>\n"
+        "    <a n=\"MyType\"><s>Job</s></a>\n"
+        "    <a n=\"TargetType\"><s>Machine</s></a>\n"
+        "    <a n=\"ClusterId\"><i>42</i></a>\n"
+        "    <a n=\"ProcId\"><i>0</i></a>\n"
+        "    <a n=\"JobStatus\"><i>2</i></a>\n"
+        "    <a n=\"Cmd\"><s>/bin/" + text + "</s></a>\n"
+        "    <a n=\"QDate\"><i>1217624885</i></a>\n"
+        "    <a n=\"WantCheckpoint\"><b v=\"f\"/></a>\n"
+        "    <a n=\"Rank\"><r>0.000000000000000E+00</r></a>\n"
+        "    <a n=\"Requirements\"><e>(Arch == \"X86_64\") &amp;&amp; "
+            "(OpSys == \"LINUX\")</e></a>\n";
+
+    for (std::size_t i = 10; i < attributes; ++i)
+    {
+        std::string const n = boost::lexical_cast<std::string>(i);
+        switch (i % 3)
+        {
+        case 0:
+            ad += "    <a n=\"Attribute" + n + "\"><i>" + n + "</i></a>\n";
+            break;
+        case 1:
+            ad += "    <a n=\"Attribute" + n + "\"><s>" + text + " " + n
+                + "</s></a>\n";
+            break;
+        case 2:
+            ad += "    <a n=\"Attribute" + n + "\"><b v=\"t\"/></a>\n";
+            break;
+        }
+    }
+
+    return ad + "</c>\n";
+}
+
+int main(int argc, char * argv[])
+{
+    std::size_t const iterations = argc > 1
+        ? boost::lexical_cast<std::size_t>(argv[1]) : 2000;
+
+    log_generator small;
+    log_generator::config config;
+    config.record_size = 4096;
+    log_generator large(config);
+
+    std::string const submit_event = small.format(0, 42);
+    std::string const terminated_event = large.format(5, 42);
+    std::string const job_ad = make_job_ad(120, false);
+    std::string const escaped_ad = make_job_ad(120, true);
+
+    // condor_q output header, and a partial record, skipped.
+    std::string garbage = "<?xml version=\"1.0\"?>\n"
+        "<!DOCTYPE classads SYSTEM \"classads.dtd\">\n"
+        "<classads>\n";
+    while (garbage.size() < 4096)
+        garbage += "<a n=\"Truncated\"><s>&lt;not a record&gt;</s></a>\n";
+    std::string const prefixed_event = garbage + submit_event;
+
+    std::cout << iterations << " iterations\n"
+        "  find_and_parse:\n";
+
+    classad c;
+
+    CHECK(parse("submit event", submit_event, iterations, c));
+    CHECK(c.get_attribute("Cluster")
+        && "42" == c.get_attribute("Cluster")->value_);
+
+    CHECK(parse("4 KB terminated event", terminated_event, iterations, c));
+    CHECK(c.get_attribute("ReturnValue")
+        && "0" == c.get_attribute("ReturnValue")->value_);
+
+    CHECK(parse("120 attribute job ad", job_ad, iterations, c));
+    CHECK(c.get_attribute("Attribute119")
+        && "t" == c.get_attribute("Attribute119")->value_);
+
+    CHECK(parse("escaped job ad", escaped_ad, iterations, c));
+    CHECK(c.get_attribute("Cmd")
+        && "/bin/a < b && c > \"d\"" == c.get_attribute("Cmd")->value_);
+
+    CHECK(parse("4 KB garbage, event", prefixed_event, iterations, c));
+    CHECK(c.get_attribute("EventTypeNumber")
+        && "0" == c.get_attribute("EventTypeNumber")->value_);
+
+    // Lookups on the 120 attribute job ad
+    {
+        std::string::const_iterator first = job_ad.begin();
+        CHECK(c.find_and_parse(first, job_ad.end()));
+    }
+
+    std::cout << "  get_attribute, 120 attribute job ad:\n";
+
+    char const * const keys[] = { "ClusterId", "JOBSTATUS", "Attribute99",
+        "Missing" };
+
+    std::size_t const lookups = 100 * iterations;
+    for (std::size_t k = 0; k < sizeof(keys) / sizeof(*keys); ++k)
+    {
+        std::size_t found = 0;
+
+        std::size_t const allocated = allocations;
+        double const start = now();
+        for (std::size_t i = 0; i < lookups; ++i)
+            if (c.get_attribute(keys[k]))
+                ++found;
+        double const elapsed = now() - start;
+
+        report(keys[k], lookups, 0, elapsed, allocations - allocated);
+        CHECK((3 == k ? 0 : lookups) == found);
+    }
+
+    return report_checks();
+}
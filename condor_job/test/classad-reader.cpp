@@ -0,0 +1,72 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "../classad_reader.hpp"
+
+#include "test_helpers.hpp"
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <iostream>
+#include <sstream>
+
+using saga::adaptors::condor::classad_reader;
+using saga::adaptors::condor::test::report_checks;
+
+void collect(std::vector<std::string> & records, std::string const & record)
+{
+    records.push_back(record);
+}
+
+int main()
+{
+    std::vector<std::string> expected;
+    std::string queue = "<?xml version=\"1.0\"?>\n"
+        "<!DOCTYPE classads SYSTEM \"classads.dtd\">\n"
+        "<classads>\n";
+
+    for (int i = 0; i < 100; ++i)
+    {
+        std::string const id = boost::lexical_cast<std::string>(i);
+        std::string const record = "<c>\n"
+            "    <a n=\"ClusterId\"><i>" + id + "</i></a>\n"
+            "    <a n=\"Cmd\"><s>/bin/" + std::string(i, 'x') + "</s></a>\n"
+            "    <a n=\"Done\"><b v=\"t\"/></a>\n"
+            "</c>";
+
+        expected.push_back(record);
+        queue += record + (i % 2 ? "\n" : "");
+    }
+    queue += "</classads>\n";
+
+    // Tags split across chunks, in every possible way
+    std::size_t const chunk_sizes[] = { 1, 2, 3, 4, 5, 7, 64, 4096 };
+    for (std::size_t i = 0; i < sizeof(chunk_sizes) / sizeof(*chunk_sizes);
+            ++i)
+    {
+        std::istringstream is(queue);
+        std::vector<std::string> records;
+
+        std::size_t count = classad_reader(chunk_sizes[i]).read(is,
+            boost::bind(&collect, boost::ref(records), _1));
+
+        CHECK(expected.size() == count);
+        CHECK(expected == records);
+    }
+
+    // No records, and a truncated one
+    {
+        std::istringstream is("<classads>\n</classads>\n"
+            "<c><a n=\"ClusterId\"><i>1</i></a>");
+        std::vector<std::string> records;
+
+        CHECK(0 == classad_reader(3).read(is,
+            boost::bind(&collect, boost::ref(records), _1)));
+        CHECK(records.empty());
+    }
+
+    return report_checks();
+}
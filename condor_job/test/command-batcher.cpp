@@ -0,0 +1,40 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "../command_batcher.hpp"
+
+#include "test_helpers.hpp"
+
+#include <iostream>
+
+int main()
+{
+    using saga::adaptors::condor::command_batcher;
+    using saga::adaptors::condor::test::report_checks;
+
+    std::set<std::string> ids = command_batcher::get_succeeded(
+        "Cluster 12 has been marked for removal.\n"
+        "Job 13.4 marked for removal\n"
+        "Couldn't find/remove all jobs in cluster 14.\n"
+        "All jobs in cluster 15 have been marked for removal\n");
+    CHECK(3 == ids.size());
+    CHECK(ids.count("12"));
+    CHECK(ids.count("13.4"));
+    CHECK(!ids.count("14"));
+    CHECK(ids.count("15"));
+
+    ids = command_batcher::get_succeeded(
+        "Cluster 20 held.\n"
+        "Job 21.0 not found\n"
+        "Job 22.1 released\n");
+    CHECK(2 == ids.size());
+    CHECK(ids.count("20"));
+    CHECK(!ids.count("21.0"));
+    CHECK(ids.count("22.1"));
+
+    CHECK(command_batcher::get_succeeded("").empty());
+
+    return report_checks();
+}
@@ -0,0 +1,149 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "../process.cpp"
+#include "../command_scheduler.cpp"
+
+#include "test_helpers.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+using saga::adaptors::condor::command_result;
+using saga::adaptors::condor::command_scheduler;
+using saga::adaptors::condor::process_launcher;
+using saga::adaptors::condor::test::now;
+using saga::adaptors::condor::test::report_checks;
+
+std::vector<std::string> shell(std::string const & script)
+{
+    std::vector<std::string> args;
+    args.push_back("-c");
+    args.push_back(script);
+    return args;
+}
+
+void write(std::string const & input, std::ostream & os)
+{
+    os << input;
+}
+
+void run_script(command_scheduler & s, std::string const & script)
+{
+    s.run("sh", shell(script));
+}
+
+void query_script(command_scheduler & s, std::string const & script,
+    std::string & output)
+{
+    output = s.query("sh", shell(script)).output;
+}
+
+int main()
+{
+    process_launcher launcher;
+
+    command_scheduler::config config;
+    config.limits["sh"] = 2;
+    config.timeout = 1.;
+
+    command_scheduler scheduler(launcher, config);
+
+    // Input and output
+    {
+        command_result r = scheduler.run("cat", std::vector<std::string>(),
+            boost::bind(&write, "Cluster 42\n", _1));
+        CHECK(r.succeeded());
+        CHECK("Cluster 42\n" == r.output);
+
+        // Input larger than a pipe buffer, read as it is written.
+        std::string const large(1 << 20, 'x');
+        r = scheduler.run("wc", std::vector<std::string>(1, "-c"),
+            boost::bind(&write, boost::cref(large), _1));
+        CHECK(r.succeeded());
+        CHECK(1 << 20 == std::atoi(r.output.c_str()));
+
+        // Input the command doesn't read fails it, instead of raising
+        // SIGPIPE.
+        r = scheduler.run("sh", shell("echo early"),
+            boost::bind(&write, boost::cref(large), _1));
+        CHECK(!r.input_complete);
+        CHECK(!r.succeeded());
+        CHECK("early\n" == r.output);
+
+        sigset_t mask;
+        pthread_sigmask(SIG_BLOCK, 0, &mask);
+        CHECK(!sigismember(&mask, SIGPIPE));
+
+        r = scheduler.run("sh", shell("echo error >&2; exit 2"));
+        CHECK(!r.succeeded());
+        CHECK(2 == r.status.exit_status());
+        CHECK("error\n" == r.output);
+    }
+
+    // At most 2 concurrent invocations of sh
+    {
+        double const start = now();
+
+        boost::thread_group threads;
+        for (int i = 0; i < 6; ++i)
+            threads.create_thread(boost::bind(&run_script,
+                boost::ref(scheduler), "sleep .2"));
+        threads.join_all();
+
+        CHECK(now() - start > .55);
+    }
+
+    // Identical queries in flight run once
+    {
+        std::string const counter = "command-scheduler.count";
+        std::remove(counter.c_str());
+
+        std::string const script = "echo >> " + counter + "; sleep .3; echo 7";
+
+        std::vector<std::string> outputs(5);
+        boost::thread_group threads;
+        for (std::size_t i = 0; i < outputs.size(); ++i)
+            threads.create_thread(boost::bind(&query_script,
+                boost::ref(scheduler), script, boost::ref(outputs[i])));
+        threads.join_all();
+
+        for (std::size_t i = 0; i < outputs.size(); ++i)
+            CHECK("7\n" == outputs[i]);
+
+        std::ifstream is(counter.c_str());
+        std::size_t runs = 0;
+        for (std::string line; std::getline(is, line); ++runs)
+            /* Nothing to do */;
+
+        CHECK(1 == runs);
+        std::remove(counter.c_str());
+    }
+
+    // Stuck commands are killed
+    {
+        double const start = now();
+
+        bool thrown = false;
+        try
+        {
+            scheduler.run("sleep", std::vector<std::string>(1, "30"));
+        }
+        catch (std::exception const &)
+        {
+            thrown = true;
+        }
+
+        CHECK(thrown);
+        CHECK(now() - start < 5.);
+
+        // Slots are released
+        CHECK(scheduler.run("sh", shell("exit 0")).succeeded());
+    }
+
+    return report_checks();
+}
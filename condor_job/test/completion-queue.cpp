@@ -0,0 +1,123 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "../completion_queue.cpp"
+
+#include "test_helpers.hpp"
+
+#include <boost/bind.hpp>
+#include <boost/config.hpp>
+
+#if !defined(BOOST_WINDOWS)
+#   include <poll.h>
+#endif
+
+#include <iostream>
+
+using saga::adaptors::condor::completion_queue;
+using saga::adaptors::condor::test::report_checks;
+
+completion_queue::entry make_entry(std::string const & id,
+    saga::job::state state = saga::job::Done, int exit_code = 0)
+{
+    completion_queue::entry e;
+    e.job_id = id;
+    e.state = state;
+    e.exit_code = exit_code;
+    return e;
+}
+
+void push_later(completion_queue & queue, std::string const & id)
+{
+    boost::thread::sleep(saga::adaptors::condor::detail::make_deadline(.1));
+    queue.push(make_entry(id));
+}
+
+bool is_readable(completion_queue const & queue)
+{
+#if !defined(BOOST_WINDOWS)
+    pollfd fd;
+    fd.fd = queue.get_fd();
+    fd.events = POLLIN;
+    return 1 == poll(&fd, 1, 0);
+#else
+    return 0 != queue.size();
+#endif
+}
+
+int main()
+{
+    completion_queue queue;
+    completion_queue::entry e;
+    std::vector<completion_queue::entry> entries;
+
+    CHECK(!queue.wait_any(e, 0.));
+    CHECK(!queue.wait_any(e, .05));
+    CHECK(0 == queue.drain(entries));
+#if !defined(BOOST_WINDOWS)
+    CHECK(-1 != queue.get_fd());
+#endif
+    CHECK(!is_readable(queue));
+
+    queue.push(make_entry("[condor://localhost]-[1]"));
+    queue.push(make_entry("[condor://localhost]-[2]", saga::job::Failed, 3));
+    queue.push(make_entry("[condor://localhost]-[3]", saga::job::Canceled));
+    CHECK(3 == queue.size());
+    CHECK(is_readable(queue));
+
+    CHECK(queue.wait_any(e, 0.));
+    CHECK("[condor://localhost]-[1]" == e.job_id);
+    CHECK(saga::job::Done == e.state);
+    CHECK(is_readable(queue));
+
+    CHECK(1 == queue.drain(entries, 1));
+    CHECK(1 == entries.size());
+    CHECK(saga::job::Failed == entries[0].state);
+    CHECK(3 == entries[0].exit_code);
+
+    CHECK(1 == queue.drain(entries));
+    CHECK(2 == entries.size());
+    CHECK(0 == queue.size());
+    CHECK(!is_readable(queue));
+
+    // Wait-all picks its own jobs, leaving others in the queue.
+    std::set<std::string> ids;
+    ids.insert("a");
+    ids.insert("b");
+
+    entries.clear();
+    queue.push(make_entry("a"));
+    queue.push(make_entry("x"));
+    CHECK(!queue.wait_all(ids, entries, .05));
+    CHECK(1 == entries.size());
+    CHECK(1 == queue.size());
+
+    entries.clear();
+    boost::thread pusher(boost::bind(&push_later, boost::ref(queue), "b"));
+    ids.erase("a");
+    CHECK(queue.wait_all(ids, entries, 10.));
+    CHECK(1 == entries.size() && "b" == entries[0].job_id);
+    pusher.join();
+
+    CHECK(queue.wait_any(e));
+    CHECK("x" == e.job_id);
+    CHECK(!is_readable(queue));
+    CHECK(0 == queue.get_dropped());
+
+    // Bounded: the oldest entries make room for new ones.
+    completion_queue bounded(2);
+    bounded.push(make_entry("1"));
+    bounded.push(make_entry("2"));
+    bounded.push(make_entry("3"));
+    CHECK(2 == bounded.size());
+    CHECK(1 == bounded.get_dropped());
+    CHECK(bounded.wait_any(e, 0.));
+    CHECK("2" == e.job_id);
+    CHECK(bounded.wait_any(e, 0.));
+    CHECK("3" == e.job_id);
+    CHECK(!is_readable(bounded));
+
+    return report_checks();
+}
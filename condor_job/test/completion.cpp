@@ -0,0 +1,68 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "../completion.hpp"
+
+#include "test_helpers.hpp"
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <iostream>
+
+using saga::adaptors::condor::completion;
+using saga::adaptors::condor::test::now;
+using saga::adaptors::condor::test::report_checks;
+
+void complete(completion & c)
+{
+    c.set_done();
+}
+
+int main()
+{
+    {
+        completion c;
+        CHECK(!c.is_done());
+        CHECK(!c.wait(0.));
+        CHECK(!c.wait(1.));
+
+        c.set_error("condor_rm failed", saga::NoSuccess);
+        CHECK(c.is_done());
+        CHECK(c.wait());
+
+        std::string message;
+        saga::error error = saga::BadParameter;
+        CHECK(c.failed(message, error));
+        CHECK("condor_rm failed" == message);
+        CHECK(saga::NoSuccess == error);
+    }
+
+    // Sub-second timeouts are waited for, not truncated.
+    {
+        completion c;
+        double const start = now();
+        CHECK(!c.wait(.5));
+        CHECK(now() - start >= .45);
+        CHECK(now() - start < 1.);
+    }
+
+    // Completed from another thread.
+    {
+        completion c;
+        boost::thread t(boost::bind(&complete, boost::ref(c)));
+
+        CHECK(c.wait());
+        CHECK(c.is_done());
+
+        std::string message;
+        saga::error error;
+        CHECK(!c.failed(message, error));
+
+        t.join();
+    }
+
+    return report_checks();
+}
@@ -0,0 +1,106 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "../dag_submitter.hpp"
+
+#include "test_helpers.hpp"
+
+#include <iostream>
+
+using saga::adaptors::condor::dag_submitter;
+using saga::adaptors::condor::test::report_checks;
+
+dag_submitter::node make_node(std::string const & name,
+    std::string const & parents = std::string())
+{
+    dag_submitter::node n;
+    n.dag = "diamond";
+    n.name = name;
+    n.dag_size = 4;
+
+    for (std::size_t i = 0; i < parents.size(); ++i)
+        n.parents.push_back(parents.substr(i, 1));
+
+    return n;
+}
+
+int main()
+{
+    // Node names
+    {
+        CHECK(dag_submitter::is_valid_node_name("A"));
+        CHECK(dag_submitter::is_valid_node_name("stage_2-b"));
+        CHECK(!dag_submitter::is_valid_node_name(""));
+        CHECK(!dag_submitter::is_valid_node_name("a b"));
+        CHECK(!dag_submitter::is_valid_node_name("a\nJOB"));
+
+        CHECK("SAGA42_1_A" == dag_submitter::get_node_key("SAGA42_1", "A"));
+    }
+
+    std::vector<std::string> files;
+    files.push_back("/tmp/a.sub");
+    files.push_back("/tmp/b.sub");
+    files.push_back("/tmp/c.sub");
+    files.push_back("/tmp/d.sub");
+
+    // DAG files, with node names tagged
+    {
+        std::vector<dag_submitter::node> nodes;
+        nodes.push_back(make_node("A"));
+        nodes.push_back(make_node("B", "A"));
+        nodes.push_back(make_node("C", "A"));
+        nodes.push_back(make_node("D", "BC"));
+
+        nodes[3].post_script.push_back("/bin/check");
+        nodes[3].post_script.push_back("two words");
+        nodes[3].post_script.push_back("$RETURN");
+
+        CHECK(dag_submitter::make_dag("T", nodes, files) ==
+            "# Generated by the SAGA Condor adaptor, for DAG diamond.\n"
+            "JOB T_A /tmp/a.sub\n"
+            "JOB T_B /tmp/b.sub\n"
+            "JOB T_C /tmp/c.sub\n"
+            "JOB T_D /tmp/d.sub\n"
+            "SCRIPT POST T_D /bin/check \"two words\" $RETURN\n"
+            "PARENT T_A CHILD T_B\n"
+            "PARENT T_A CHILD T_C\n"
+            "PARENT T_B T_C CHILD T_D\n");
+    }
+
+    // Parents must be nodes of the DAG, in any order
+    {
+        std::vector<dag_submitter::node> nodes;
+        nodes.push_back(make_node("D", "BC"));
+        nodes.push_back(make_node("B", "A"));
+        nodes.push_back(make_node("C", "A"));
+        nodes.push_back(make_node("A"));
+
+        std::string dag;
+        try
+        {
+            dag = dag_submitter::make_dag("T", nodes, files);
+        }
+        catch (saga::exception const &)
+        {
+        }
+        CHECK(std::string::npos != dag.find("PARENT T_B T_C CHILD T_D\n"));
+
+        nodes[3].name = "X";
+
+        bool thrown = false;
+        try
+        {
+            dag_submitter::make_dag("T", nodes, files);
+        }
+        catch (saga::exception const & e)
+        {
+            thrown = true;
+            CHECK(saga::BadParameter == e.get_error());
+        }
+        CHECK(thrown);
+    }
+
+    return report_checks();
+}
@@ -0,0 +1,178 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "../history_cache.cpp"
+
+#include "test_helpers.hpp"
+
+#include <boost/bind.hpp>
+
+#include <iostream>
+#include <sstream>
+
+using saga::adaptors::condor::history_cache;
+using saga::adaptors::condor::test::report_checks;
+
+std::string classad(int cluster, int proc, int status = 4)
+{
+    std::string const c = boost::lexical_cast<std::string>(cluster);
+    std::string const p = boost::lexical_cast<std::string>(proc);
+    std::string const s = boost::lexical_cast<std::string>(status);
+
+    return "<c>\n"
+        "    <a n=\"MyType\"><s>Job</s></a>\n"
+        "    <a n=\"ClusterId\"><i>" + c + "</i></a>\n"
+        "    <a n=\"ProcId\"><i>" + p + "</i></a>\n"
+        "    <a n=\"JobStatus\"><i>" + s + "</i></a>\n"
+        "</c>";
+}
+
+//  Stands in for condor_history: "-match N" returns the first N ClassAds
+//  of history, "-constraint" those of the cluster in the constraint.
+void fetch(std::vector<std::vector<std::string> > & calls,
+    std::vector<std::string> const & history,
+    std::vector<std::string> const & args,
+    saga::adaptors::condor::classad_reader::callback const & f)
+{
+    calls.push_back(args);
+
+    std::string xml;
+    if ("-match" == args[0])
+    {
+        std::size_t const n = boost::lexical_cast<std::size_t>(args[1]);
+        for (std::size_t i = 0; i < n && i < history.size(); ++i)
+            xml += history[i] + "\n";
+    }
+    else
+    {
+        // "ClusterId == N ..."
+        std::istringstream constraint(args[1]);
+        std::string attribute, op, id;
+        constraint >> attribute >> op >> id;
+
+        std::string const cluster = "<i>" + id + "</i>";
+        for (std::size_t i = 0; i < history.size(); ++i)
+            if (std::string::npos != history[i].find(cluster))
+                xml += history[i] + "\n";
+    }
+
+    std::istringstream is("<classads>\n" + xml + "</classads>\n");
+    saga::adaptors::condor::classad_reader(16).read(is, f);
+}
+
+int main()
+{
+    // Most recent first. Cluster 21's processes finished apart.
+    std::vector<std::string> history;
+    history.push_back(classad(30, 0));
+    history.push_back(classad(21, 1, 3));
+    history.push_back(classad(20, 0));
+    history.push_back(classad(21, 0, 3));
+    history.push_back(classad(11, 0));
+    history.push_back(classad(10, 0));
+
+    std::vector<std::vector<std::string> > calls;
+    history_cache::config config;
+    config.capacity = 3;
+
+    history_cache cache(
+        boost::bind(&fetch, boost::ref(calls), boost::cref(history), _1, _2),
+        config);
+
+    // One sweep serves recently finished processes
+    {
+        std::string ads;
+        CHECK(cache.get_job("30.0", ads));
+        CHECK(classad(30, 0) == ads);
+        CHECK(1 == calls.size());
+        CHECK(calls.size() == 1 && "-match" == calls[0][0]
+            && "3" == calls[0][1]);
+
+        CHECK(cache.get_job("21.1", ads));
+        CHECK(classad(21, 1, 3) == ads);
+        CHECK(cache.get_job("20.0", ads));
+        CHECK(1 == calls.size());
+        CHECK(3 == cache.size());
+    }
+
+    // The sweep read part of cluster 21, whole clusters are read again
+    {
+        std::string ads;
+        CHECK(cache.get_job("21", ads));
+        CHECK(classad(21, 0, 3) + "\n" + classad(21, 1, 3) + "\n" == ads);
+        CHECK(2 == calls.size());
+        CHECK(calls.size() == 2 && 2 == calls[1].size()
+            && "-constraint" == calls[1][0]
+            && "ClusterId == 21" == calls[1][1]);
+
+        CHECK(cache.get_job("21", ads));
+        CHECK(2 == calls.size());
+    }
+
+    // Older jobs are looked up on their own, and kept
+    {
+        std::string ads;
+        CHECK(cache.get_job("10.0", ads));
+        CHECK(classad(10, 0) == ads);
+        CHECK(3 == calls.size());
+        CHECK(calls.size() == 3 && "-constraint" == calls[2][0]
+            && "ClusterId == 10 && ProcId == 0" == calls[2][1]);
+
+        CHECK(cache.get_job("10.0", ads));
+        CHECK(3 == calls.size());
+
+        // Read by process, the cluster may have others
+        CHECK(cache.get_job("10", ads));
+        CHECK(4 == calls.size());
+        CHECK(cache.get_job("10", ads));
+        CHECK(4 == calls.size());
+        CHECK(3 == cache.size());
+    }
+
+    // Least recently used are dropped
+    {
+        std::string ads;
+        CHECK(cache.get_job("21", ads));
+        CHECK(cache.get_job("11", ads));
+        CHECK(5 == calls.size());
+        CHECK(3 == cache.size());
+
+        // 20 was dropped, 21 was not
+        CHECK(cache.get_job("21", ads));
+        CHECK(5 == calls.size());
+        CHECK(cache.get_job("20.0", ads));
+        CHECK(6 == calls.size());
+    }
+
+    // Unknown, unfinished and malformed jobs
+    {
+        history.push_back(classad(40, 0, 2));
+
+        std::string ads;
+        CHECK(!cache.get_job("40", ads));
+        CHECK(!cache.get_job("99.0", ads));
+        CHECK(8 == calls.size());
+
+        CHECK(!cache.get_job("1 || true", ads));
+        CHECK(!cache.get_job("10.x", ads));
+        CHECK(8 == calls.size());
+    }
+
+    // Without caching, every lookup queries the history
+    {
+        config.capacity = 0;
+        history_cache uncached(boost::bind(&fetch, boost::ref(calls),
+            boost::cref(history), _1, _2), config);
+
+        std::string ads;
+        CHECK(uncached.get_job("21", ads));
+        CHECK(classad(21, 0, 3) + "\n" + classad(21, 1, 3) + "\n" == ads);
+        CHECK(uncached.get_job("21", ads));
+        CHECK(10 == calls.size());
+        CHECK(0 == uncached.size());
+    }
+
+    return report_checks();
+}
@@ -0,0 +1,225 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+//  Measures the memory held per tracked job, e.g.:
+//
+//      job-footprint [jobs]
+//
+//  Jobs are built up as the adaptor does for a finished job, one component
+//  at a time, measuring the heap bytes each adds per job:
+//
+//      shared_job_data     The job, and its shared_ptr's control block
+//      IDs                 Cluster ID and full job ID
+//      attributes          JobID, Finished and ExitCode
+//      instances           A job CPI instance
+//      registry            A registry entry under its Cluster ID
+//      description         Executable and arguments
+//
+//  Reports sizes of the job's members, and compares the measured bytes with
+//  the estimate job_registry::add_footprint reports at runtime.
+
+#include "../job_registry.cpp"
+#include "../synchronized.hpp"
+
+#include "test_helpers.hpp"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+//  Heap bytes in use, tracked by operator new in a header before each block.
+std::size_t heap_bytes = 0;
+
+std::size_t const header_size = 16;
+
+void * operator new(std::size_t size) throw (std::bad_alloc)
+{
+    if (char * p = static_cast<char *>(std::malloc(size + header_size)))
+    {
+        *reinterpret_cast<std::size_t *>(p) = size;
+        heap_bytes += size;
+        return p + header_size;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void * p) throw ()
+{
+    if (!p)
+        return;
+
+    char * const block = static_cast<char *>(p) - header_size;
+    heap_bytes -= *reinterpret_cast<std::size_t *>(block);
+    std::free(block);
+}
+
+using saga::adaptors::condor::job_cpi_impl;
+using saga::adaptors::condor::job_footprint;
+using saga::adaptors::condor::job_registry;
+using saga::adaptors::condor::shared_job_data;
+using saga::adaptors::condor::synchronized;
+using saga::adaptors::condor::test::report_checks;
+
+typedef std::vector<boost::shared_ptr<shared_job_data> > job_list;
+
+//  Per job heap bytes, as allocated. Excludes malloc's own bookkeeping,
+//  which the estimate includes.
+void report(std::string const & name, std::size_t bytes, std::size_t jobs)
+{
+    std::cout << "  " << std::left << std::setw(20) << name << std::right
+        << std::setw(10) << std::fixed << std::setprecision(1)
+        << double(bytes) / jobs << "\n" << std::flush;
+}
+
+void report_size(std::string const & name, std::size_t size)
+{
+    std::cout << "  " << std::left << std::setw(20) << name << std::right
+        << std::setw(10) << size << "\n";
+}
+
+int main(int argc, char const ** argv)
+{
+    std::size_t job_count = 100000;
+    try
+    {
+        if (argc > 1)
+            job_count = boost::lexical_cast<std::size_t>(argv[1]);
+    }
+    catch (boost::bad_lexical_cast const &)
+    {
+        std::cout << "Usage: " << argv[0] << " [jobs]\n";
+        return 1;
+    }
+
+    if (!job_count)
+        job_count = 1;
+
+    std::cout << "sizeof (bytes):\n";
+    report_size("shared_job_data", sizeof(shared_job_data));
+    report_size("  description", sizeof(saga::job::description));
+    report_size("  attribute_map", sizeof(shared_job_data::attribute_map));
+    report_size("  instances", sizeof(std::set<job_cpi_impl *>));
+    report_size("  procs", sizeof(saga::adaptors::condor::proc_table));
+    report_size("  strings", 2 * sizeof(std::string));
+    report_size("  state_change", sizeof(boost::condition));
+    report_size("  mutex", sizeof(shared_job_data::mutex));
+
+    std::size_t const live_count = shared_job_data::get_live_count();
+
+    job_list jobs;
+    jobs.reserve(job_count);
+
+    // Fake CPI instance, never dereferenced.
+    job_cpi_impl * const instance = reinterpret_cast<job_cpi_impl *>(&jobs);
+
+    std::size_t measured = 0;
+    job_footprint before_description, after_description;
+
+    std::cout << job_count << " jobs, heap bytes per job:\n";
+    {
+        synchronized<job_registry> registry;
+
+        std::size_t bytes = heap_bytes;
+        for (std::size_t i = 0; i < job_count; ++i)
+            jobs.push_back(boost::shared_ptr<shared_job_data>(
+                new shared_job_data));
+        report("shared_job_data", heap_bytes - bytes, job_count);
+        measured += heap_bytes - bytes;
+
+        CHECK(live_count + job_count == shared_job_data::get_live_count());
+
+        bytes = heap_bytes;
+        for (std::size_t i = 0; i < job_count; ++i)
+        {
+            shared_job_data & job = *jobs[i];
+            job.cluster_id = boost::lexical_cast<std::string>(i + 1);
+            job.full_job_id = "[condor://localhost]-[" + job.cluster_id + "]";
+        }
+        report("IDs", heap_bytes - bytes, job_count);
+        measured += heap_bytes - bytes;
+
+        bytes = heap_bytes;
+        for (std::size_t i = 0; i < job_count; ++i)
+        {
+            using namespace saga::job::attributes;
+
+            shared_job_data & job = *jobs[i];
+            job.attributes[jobid] = job.full_job_id;
+            job.attributes[finished] = "2008-08-01T23:08:05";
+            job.attributes[exitcode] = "0";
+        }
+        report("attributes", heap_bytes - bytes, job_count);
+        measured += heap_bytes - bytes;
+
+        bytes = heap_bytes;
+        for (std::size_t i = 0; i < job_count; ++i)
+            jobs[i]->instances.insert(instance);
+        report("instances", heap_bytes - bytes, job_count);
+        measured += heap_bytes - bytes;
+
+        bytes = heap_bytes;
+        for (std::size_t i = 0; i < job_count; ++i)
+            synchronized<job_registry>::lock(registry)->register_job(jobs[i]);
+        report("registry", heap_bytes - bytes, job_count);
+        measured += heap_bytes - bytes;
+
+        synchronized<job_registry>::lock(registry)->add_footprint(
+            before_description);
+
+        bytes = heap_bytes;
+        {
+            std::vector<std::string> arguments;
+            arguments.push_back("10");
+
+            for (std::size_t i = 0; i < job_count; ++i)
+            {
+                using namespace saga::job::attributes;
+
+                saga::job::description & jd = jobs[i]->description;
+                jd.set_attribute(description_executable, "/bin/sleep");
+                jd.set_vector_attribute(description_arguments, arguments);
+            }
+        }
+        std::size_t const description = heap_bytes - bytes;
+        report("description", description, job_count);
+
+        synchronized<job_registry>::lock(registry)->add_footprint(
+            after_description);
+        after_description.live = shared_job_data::get_live_count();
+
+        std::cout << "  " << std::left << std::setw(20) << "total"
+            << std::right << std::setw(10) << std::setprecision(1)
+            << double(measured + description) / job_count << "\n";
+
+        std::cout << "add_footprint estimate, bytes per job:\n";
+        report("without description", before_description.bytes, job_count);
+        report("description", after_description.bytes
+            - before_description.bytes, job_count);
+        report("total", after_description.bytes, job_count);
+
+        CHECK(job_count == before_description.tracked);
+        CHECK(job_count == after_description.tracked);
+        CHECK(live_count + job_count == after_description.live);
+
+        // Within malloc's bookkeeping, and then some, of the measured bytes.
+        CHECK(before_description.bytes >= measured / 2);
+        CHECK(before_description.bytes <= measured * 2);
+
+        // Registered jobs may not have instances once the registry goes.
+        for (std::size_t i = 0; i < job_count; ++i)
+            jobs[i]->instances.clear();
+    }
+
+    jobs.clear();
+    CHECK(live_count == shared_job_data::get_live_count());
+
+    return report_checks();
+}
@@ -0,0 +1,103 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "../job_lister.hpp"
+
+#include "test_helpers.hpp"
+
+#include <boost/bind.hpp>
+
+#include <iostream>
+#include <sstream>
+
+using saga::adaptors::condor::job_lister;
+using saga::adaptors::condor::test::report_checks;
+
+void collect(std::vector<std::vector<std::string> > & pages,
+    std::vector<std::string> const & page)
+{
+    pages.push_back(page);
+}
+
+int main()
+{
+    // Constraints
+    {
+        job_lister::config config;
+        CHECK(job_lister(config).get_constraint().empty());
+
+        std::vector<std::string> args = job_lister(config).get_arguments();
+        CHECK(3 == args.size());
+        CHECK(args.size() == 3 && "-af" == args[0]);
+
+        config.owner = "jdoe";
+        config.session_tag = "run \"7\"";
+        config.states.insert(job_lister::get_state_code("Idle"));
+        config.states.insert(job_lister::get_state_code("Held"));
+
+        CHECK("Owner == \"jdoe\" && SagaSession == \"run \\\"7\\\"\""
+            " && (JobStatus == 1 || JobStatus == 5)"
+                == job_lister(config).get_constraint());
+
+        args = job_lister(config).get_arguments();
+        CHECK(5 == args.size());
+        CHECK(args.size() == 5 && "-constraint" == args[0]);
+
+        CHECK(4 == job_lister::get_state_code("Completed"));
+        CHECK(-1 == job_lister::get_state_code("Done"));
+    }
+
+    // Lines
+    {
+        std::string cluster, proc;
+        CHECK(job_lister::parse_line("12 3", cluster, proc));
+        CHECK("12" == cluster && "3" == proc);
+        CHECK(job_lister::parse_line("7  0 \r", cluster, proc));
+        CHECK("7" == cluster && "0" == proc);
+
+        CHECK(!job_lister::parse_line("", cluster, proc));
+        CHECK(!job_lister::parse_line("12", cluster, proc));
+        CHECK(!job_lister::parse_line("12 ", cluster, proc));
+        CHECK(!job_lister::parse_line("12 undefined", cluster, proc));
+        CHECK(!job_lister::parse_line("12 3 4", cluster, proc));
+        CHECK(!job_lister::parse_line(" 12 3", cluster, proc));
+    }
+
+    // Pages
+    {
+        std::string const output = "10 0\n10 1\n10 2\n11 0\n"
+            "-- Failed to fetch ads from: <1.2.3.4>\n12 0\n";
+
+        job_lister::config config;
+        config.page_size = 3;
+
+        std::vector<std::vector<std::string> > pages;
+        std::istringstream is(output);
+        CHECK(8 == job_lister(config).read(is,
+            boost::bind(&collect, boost::ref(pages), _1)));
+
+        CHECK(3 == pages.size());
+        CHECK(pages.size() == 3
+            && 3 == pages[0].size() && 3 == pages[1].size()
+            && 2 == pages[2].size());
+        CHECK(pages.size() == 3 && pages[0].size() == 3
+            && "10" == pages[0][0] && "10.0" == pages[0][1]
+            && "10.1" == pages[0][2]);
+        CHECK(pages.size() == 3 && pages[2].size() == 2
+            && "12" == pages[2][0] && "12.0" == pages[2][1]);
+
+        // Clusters only
+        config.processes = false;
+        pages.clear();
+        std::istringstream clusters(output);
+        CHECK(3 == job_lister(config).read(clusters,
+            boost::bind(&collect, boost::ref(pages), _1)));
+        CHECK(1 == pages.size());
+        CHECK(pages.size() == 1 && 3 == pages[0].size()
+            && "11" == pages[0][1]);
+    }
+
+    return report_checks();
+}
@@ -3,51 +3,334 @@
 //  Distributed under the Boost Software License, Version 1.0. (See accompanying
 //  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
+//  Measures log_processor throughput on a synthetic job log, written as the
+//  processor reads it, e.g.:
+//
+//      log-processor [events [clusters [record-size [mix [chunk [split]]]]]]
+//
+//  Jobs for all clusters are registered beforehand. Mix is the event types,
+//  and their weights, between submission and termination, as
+//  "type:weight,..." (empty for "1:2,6:4,12:1,13:1"). Records are written
+//  whole by default, or in chunks of chunk bytes regardless of record
+//  boundaries. A fraction split of the records is written in two halves,
+//  leaving the processor with an incomplete record in between.
+//
+//  Reports events and bytes per second, the latency from writing a
+//  JobTerminatedEvent to the job's completion, and peak RSS.
+
 #include "../job_registry.cpp"
 #include "../synchronized.hpp"
 #include "../log_processor.cpp"
 
+#include "log_generator.hpp"
+#include "test_helpers.hpp"
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/thread.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
 #include <iostream>
+#include <vector>
 
-int main(int argc, char const ** argv)
+using saga::adaptors::condor::job_registry;
+using saga::adaptors::condor::log_processor;
+using saga::adaptors::condor::shared_job_data;
+using saga::adaptors::condor::synchronized;
+using saga::adaptors::condor::test::log_generator;
+using saga::adaptors::condor::test::now;
+using saga::adaptors::condor::test::percentile;
+using saga::adaptors::condor::test::report_checks;
+
+//  JobTerminatedEvents, in the order they were written, and completion
+//  times of their jobs.
+struct terminations
+{
+    terminations(
+            std::vector<boost::shared_ptr<shared_job_data> > const & jobs)
+        : jobs_(jobs)
+        , finished_(false)
+        , last_(0.)
+        , missed_(0)
+    {
+    }
+
+    void written(std::size_t cluster, double time)
+    {
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+            written_.push_back(std::make_pair(cluster, time));
+        }
+        cond_.notify_one();
+    }
+
+    void finish()
+    {
+        {
+            boost::mutex::scoped_lock lock(mtx_);
+            finished_ = true;
+        }
+        cond_.notify_one();
+    }
+
+    //  Waits for jobs to complete in the order their termination was
+    //  written, which is the order the log processor sees them in.
+    void operator()()
+    {
+        for (;;)
+        {
+            std::pair<std::size_t, double> entry;
+            {
+                boost::mutex::scoped_lock lock(mtx_);
+                while (written_.empty() && !finished_)
+                    cond_.wait(lock);
+
+                if (written_.empty())
+                    return;
+
+                entry = written_.front();
+                written_.pop_front();
+            }
+
+            // Jobs not completed by then are counted as missed.
+            if (wait(*jobs_[entry.first - 1], 30.))
+            {
+                last_ = now();
+                latencies_.push_back(last_ - entry.second);
+            }
+            else
+                ++missed_;
+        }
+    }
+
+    // Valid once operator() returns.
+    std::vector<double> & get_latencies() { return latencies_; }
+    double get_last() const { return last_; }
+    std::size_t get_missed() const { return missed_; }
+
+private:
+    static bool wait(shared_job_data & job, double timeout)
+    {
+        shared_job_data::scoped_lock lock(job.state_change_mtx);
+        return job.state_change.timed_wait(lock,
+            saga::adaptors::condor::detail::make_deadline(timeout),
+            boost::bind(&shared_job_data::is_state_final, &job, -1));
+    }
+
+    std::vector<boost::shared_ptr<shared_job_data> > const & jobs_;
+
+    boost::mutex mtx_;
+    boost::condition cond_;
+    std::deque<std::pair<std::size_t, double> > written_;
+    bool finished_;
+
+    std::vector<double> latencies_;
+    double last_;
+    std::size_t missed_;
+};
+
+//  Writes the log, reporting terminations once their record is fully
+//  written.
+struct log_writer
 {
-    using saga::adaptors::condor::log_processor;
-    using saga::adaptors::condor::job_registry;
-    using saga::adaptors::condor::synchronized;
+    log_writer(int fd, terminations & t)
+        : fd_(fd)
+        , terminations_(t)
+        , queued_(0)
+        , written_(0)
+    {
+    }
+
+    //  A record of size bytes is queued for writing, the termination of
+    //  cluster if not 0.
+    void queued(std::size_t size, std::size_t cluster = 0)
+    {
+        queued_ += size;
+        if (cluster)
+            pending_.push_back(std::make_pair(cluster, queued_));
+    }
 
-    // Test mode
-    if (argc == 1)
+    void write(char const * data, std::size_t size)
     {
-        static char const * alternate_argv[] = { argv[0]
-                , "saga-condor-log.classad"
-            };
+        while (size)
+        {
+            ssize_t const n = ::write(fd_, data, size);
+            if (n <= 0)
+                return;
+            data += n;
+            size -= n;
+            written_ += n;
+        }
 
-        argc = sizeof(alternate_argv)/sizeof(alternate_argv[0]);
-        argv = alternate_argv;
+        double const time = now();
+        while (!pending_.empty() && pending_.front().second <= written_)
+        {
+            terminations_.written(pending_.front().first, time);
+            pending_.pop_front();
+        }
     }
 
-    if (argc < 2)
+private:
+    int fd_;
+    terminations & terminations_;
+
+    // Clusters, and the offset their termination record ends at.
+    std::deque<std::pair<std::size_t, std::size_t> > pending_;
+    std::size_t queued_;
+    std::size_t written_;
+};
+
+int main(int argc, char const ** argv)
+{
+    log_generator::config config;
+    std::size_t chunk = 0;
+    double split = 0.;
+
+    try
+    {
+        if (argc > 1)
+            config.events = boost::lexical_cast<std::size_t>(argv[1]);
+        if (argc > 2)
+            config.clusters = boost::lexical_cast<std::size_t>(argv[2]);
+        if (argc > 3)
+            config.record_size = boost::lexical_cast<std::size_t>(argv[3]);
+        if (argc > 4 && *argv[4] && !config.set_mix(argv[4]))
+        {
+            std::cout << "Bad event mix: " << argv[4] << "\n";
+            return 1;
+        }
+        if (argc > 5)
+            chunk = boost::lexical_cast<std::size_t>(argv[5]);
+        if (argc > 6)
+            split = boost::lexical_cast<double>(argv[6]);
+    }
+    catch (boost::bad_lexical_cast const &)
     {
-        std::cout << "Logfile not specified.\n"
-            << std::flush;
+        std::cout << "Usage: " << argv[0] << " [events [clusters "
+            "[record-size [mix [chunk [split]]]]]]\n";
         return 1;
     }
 
-    boost::xtime t;
-    boost::xtime_get(&t, boost::TIME_UTC);
+    log_generator generator(config);
+    std::size_t const clusters = generator.get_config().clusters;
+    std::size_t const events = generator.get_config().events;
 
+    std::string const filename = "log-processor.log";
+    std::remove(filename.c_str());
+
+    int const fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND,
+        0644);
+    if (fd < 0)
+    {
+        std::cout << "Can't create " << filename << "\n";
+        return 1;
+    }
+
+    // Registry, and the jobs to wait for.
     synchronized<job_registry> registry;
-    std::vector<boost::shared_ptr<log_processor> > logs;
-    for (int i = 1; i < argc; ++i)
+    std::vector<boost::shared_ptr<shared_job_data> > jobs;
+
+    jobs.reserve(clusters);
+    for (std::size_t i = 1; i <= clusters; ++i)
+    {
+        boost::shared_ptr<shared_job_data> job(new shared_job_data);
+        job->state = saga::job::Running;
+        job->cluster_id = boost::lexical_cast<std::string>(i);
+
+        synchronized<job_registry>::lock(registry)->register_job(job);
+        jobs.push_back(job);
+    }
+
+    std::size_t bytes = 0;
+    double start, written;
+    terminations terminated(jobs);
     {
-        std::cout << "Queueing log file: " << argv[i] << std::endl;
-        boost::shared_ptr<log_processor> p(new log_processor(argv[i], registry));
-        logs.push_back(p);
+        log_processor processor(filename, registry);
+        boost::thread collector(boost::ref(terminated));
+
+        log_writer writer(fd, terminated);
+        std::string record, buffer;
+        int type;
+        std::size_t cluster;
+        unsigned seed = 54321;
+
+        start = now();
+        while (generator.next(record, type, cluster))
+        {
+            bytes += record.size();
+            writer.queued(record.size(), 5 == type ? cluster : 0);
+
+            seed = seed * 1103515245u + 12345u;
+            if (split > 0. && ((seed >> 16) & 0x7fff) < split * 0x8000)
+            {
+                // Half a record, then the rest.
+                std::size_t const half = record.size() / 2;
+                buffer.append(record, 0, half);
+                writer.write(buffer.data(), buffer.size());
+                buffer.assign(record, half, std::string::npos);
+                sched_yield();
+            }
+            else
+                buffer += record;
+
+            if (!chunk)
+            {
+                writer.write(buffer.data(), buffer.size());
+                buffer.clear();
+                continue;
+            }
+
+            std::size_t offset = 0;
+            for (; buffer.size() - offset >= chunk; offset += chunk)
+                writer.write(buffer.data() + offset, chunk);
+            buffer.erase(0, offset);
+        }
+
+        writer.write(buffer.data(), buffer.size());
+        written = now();
+
+        terminated.finish();
+        collector.join();
     }
+    ::close(fd);
+
+    std::vector<double> & latencies = terminated.get_latencies();
+    std::sort(latencies.begin(), latencies.end());
+
+    double const elapsed
+        = (latencies.empty() ? written : terminated.get_last()) - start;
+
+    rusage usage;
+    ::getrusage(RUSAGE_SELF, &usage);
+
+    std::cout << events << " events (" << bytes << " bytes) for " << clusters
+        << " clusters in " << elapsed << " s:\n"
+        "  " << events / elapsed << " events/s, "
+        << bytes / elapsed / (1024 * 1024) << " MB/s\n"
+        "  JobTerminatedEvent to completion (ms): p50 "
+        << 1e3 * percentile(latencies, 0.5) << ", p90 "
+        << 1e3 * percentile(latencies, 0.9) << ", p99 "
+        << 1e3 * percentile(latencies, 0.99) << ", max "
+        << 1e3 * (latencies.empty() ? 0. : latencies.back()) << "\n"
+        "  Peak RSS: " << usage.ru_maxrss / 1024 << " MB\n";
+
+    CHECK(0 == terminated.get_missed());
+    CHECK(clusters == latencies.size());
+    for (std::size_t i = 0; i < clusters; ++i)
+    {
+        shared_job_data::scoped_lock lock(jobs[i]->state_change_mtx);
+        CHECK(saga::job::Done == jobs[i]->state);
+    }
+
+    std::remove(filename.c_str());
 
-    t.sec += 1;
-    boost::thread::sleep(t);
+    return report_checks();
 }
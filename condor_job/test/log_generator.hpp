@@ -0,0 +1,255 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_TEST_LOG_GENERATOR_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_TEST_LOG_GENERATOR_HPP
+
+#include <boost/lexical_cast.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace saga { namespace adaptors { namespace condor { namespace test {
+
+    //  Synthetic XML job log events, as Condor writes them. Events of
+    //  clusters 1 to clusters are interleaved: each cluster starts with a
+    //  SubmitEvent, ends with a JobTerminatedEvent, and has events drawn from
+    //  the mix in between.
+    struct log_generator
+    {
+        struct config
+        {
+            config()
+                : events(100000)
+                , clusters(1000)
+                , record_size(0)
+            {
+                // ExecuteEvent, JobImageSizeEvent, JobHeldEvent,
+                // JobReleaseEvent
+                mix.push_back(std::make_pair(1, 2u));
+                mix.push_back(std::make_pair(6, 4u));
+                mix.push_back(std::make_pair(12, 1u));
+                mix.push_back(std::make_pair(13, 1u));
+            }
+
+            // Parses "type:weight,..." into mix. Returns false on errors.
+            bool set_mix(std::string const & spec)
+            {
+                std::vector<std::pair<int, unsigned> > result;
+
+                std::string::size_type begin = 0;
+                while (begin < spec.size())
+                {
+                    std::string::size_type end = spec.find(',', begin);
+                    if (std::string::npos == end)
+                        end = spec.size();
+
+                    std::string const item = spec.substr(begin, end - begin);
+                    std::string::size_type const colon = item.find(':');
+                    try
+                    {
+                        result.push_back(std::make_pair(
+                            boost::lexical_cast<int>(item.substr(0, colon)),
+                            std::string::npos == colon ? 1u
+                                : boost::lexical_cast<unsigned>(
+                                    item.substr(colon + 1))));
+                    }
+                    catch (boost::bad_lexical_cast const &)
+                    {
+                        return false;
+                    }
+
+                    begin = end + 1;
+                }
+
+                if (result.empty())
+                    return false;
+
+                mix.swap(result);
+                return true;
+            }
+
+            // Total number of events, at least two per cluster.
+            std::size_t events;
+            std::size_t clusters;
+
+            //  Records are padded to about this many bytes. 0 for no
+            //  padding.
+            std::size_t record_size;
+
+            //  EventTypeNumber and weight of events between submission and
+            //  termination.
+            std::vector<std::pair<int, unsigned> > mix;
+        };
+
+        explicit log_generator(config const & c = config())
+            : config_(c)
+            , index_(0)
+            , seed_(12345)
+            , total_weight_(0)
+        {
+            if (!config_.clusters)
+                config_.clusters = 1;
+            if (config_.events < 2 * config_.clusters)
+                config_.events = 2 * config_.clusters;
+
+            for (std::size_t i = 0; i < config_.mix.size(); ++i)
+                total_weight_ += config_.mix[i].second;
+        }
+
+        bool done() const
+        {
+            return index_ >= config_.events;
+        }
+
+        //  Next event, with its type and cluster. Returns false once all
+        //  events have been generated.
+        bool next(std::string & record, int & type, std::size_t & cluster)
+        {
+            if (done())
+                return false;
+
+            //  Each cluster gets events / clusters events, the first
+            //  events % clusters one more, in an extra round.
+            std::size_t const clusters = config_.clusters;
+            std::size_t const base = config_.events / clusters;
+            std::size_t const extra = config_.events % clusters;
+
+            std::size_t round, c;
+            if (index_ < base * clusters)
+            {
+                round = index_ / clusters;
+                c = index_ % clusters;
+            }
+            else
+            {
+                round = base;
+                c = index_ - base * clusters;
+            }
+
+            std::size_t const count = base + (c < extra ? 1 : 0);
+
+            cluster = c + 1;
+            type = !round ? 0 : (count - 1 == round ? 5 : draw());
+
+            ++index_;
+            record = format(type, cluster);
+            return true;
+        }
+
+        //  A log record of event type for cluster, process 0.
+        std::string format(int type, std::size_t cluster) const
+        {
+            std::string const name = get_name(type);
+            std::string record = "<c>\n"
+                "    <a n=\"MyType\"><s>" + name + "</s></a>\n"
+                "    <a n=\"EventTypeNumber\"><i>"
+                    + boost::lexical_cast<std::string>(type) + "</i></a>\n"
+                "    <a n=\"MyType\"><s>" + name + "</s></a>\n"
+                "    <a n=\"EventTime\"><s>2008-08-01T23:08:05</s></a>\n"
+                "    <a n=\"Cluster\"><i>"
+                    + boost::lexical_cast<std::string>(cluster) + "</i></a>\n"
+                "    <a n=\"Proc\"><i>0</i></a>\n"
+                "    <a n=\"Subproc\"><i>0</i></a>\n";
+
+            switch (type)
+            {
+            case 0:
+                record += "    <a n=\"SubmitHost\">"
+                    "<s>&lt;127.0.1.1:55333&gt;</s></a>\n";
+                break;
+
+            case 1:
+                record += "    <a n=\"ExecuteHost\">"
+                    "<s>&lt;127.0.1.1:46579&gt;</s></a>\n";
+                break;
+
+            case 5:
+                record += "    <a n=\"TerminatedNormally\"><b v=\"t\"/></a>\n"
+                    "    <a n=\"ReturnValue\"><i>0</i></a>\n"
+                    "    <a n=\"RunLocalUsage\">"
+                    "<s>Usr 0 00:00:00, Sys 0 00:00:00</s></a>\n"
+                    "    <a n=\"RunRemoteUsage\">"
+                    "<s>Usr 0 00:00:00, Sys 0 00:00:00</s></a>\n"
+                    "    <a n=\"SentBytes\">"
+                    "<r>0.000000000000000E+00</r></a>\n"
+                    "    <a n=\"ReceivedBytes\">"
+                    "<r>0.000000000000000E+00</r></a>\n";
+                break;
+
+            case 6:
+                record += "    <a n=\"Size\"><i>2048</i></a>\n";
+                break;
+
+            case 12:
+                record += "    <a n=\"HoldReason\">"
+                    "<s>via condor_hold (by user saga)</s></a>\n";
+                break;
+            }
+
+            static std::string const padding_begin
+                = "    <a n=\"Padding\"><s>";
+            static std::string const padding_end = "</s></a>\n";
+            static std::string const end = "</c>\n";
+
+            std::size_t const size = record.size() + end.size()
+                + padding_begin.size() + padding_end.size();
+            if (config_.record_size > size)
+                record += padding_begin
+                    + std::string(config_.record_size - size, 'x')
+                    + padding_end;
+
+            return record + end;
+        }
+
+        config const & get_config() const
+        {
+            return config_;
+        }
+
+        static std::string get_name(int type)
+        {
+            switch (type)
+            {
+            case 0: return "SubmitEvent";
+            case 1: return "ExecuteEvent";
+            case 5: return "JobTerminatedEvent";
+            case 6: return "JobImageSizeEvent";
+            case 9: return "JobAbortedEvent";
+            case 12: return "JobHeldEvent";
+            case 13: return "JobReleaseEvent";
+            }
+            return "GenericEvent";
+        }
+
+    private:
+        // Deterministic, so runs are comparable.
+        int draw()
+        {
+            if (!total_weight_)
+                return 1;
+
+            seed_ = seed_ * 1103515245u + 12345u;
+            unsigned pick = (seed_ >> 16) % total_weight_;
+
+            for (std::size_t i = 0; i < config_.mix.size(); ++i)
+            {
+                if (pick < config_.mix[i].second)
+                    return config_.mix[i].first;
+                pick -= config_.mix[i].second;
+            }
+            return config_.mix.back().first;
+        }
+
+        config config_;
+        std::size_t index_;
+        unsigned seed_;
+        unsigned total_weight_;
+    };
+
+}}}} // namespace saga::adaptors::condor::test
+
+#endif // include guard
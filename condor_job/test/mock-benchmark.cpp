@@ -0,0 +1,257 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+//  End-to-end benchmark of the adaptor against the mock Condor tools in
+//  mock_condor/, e.g.:
+//
+//      mock-benchmark [mock-directory [jobs [cancels]]]
+//
+//  Reports the submission rate, the latency from the mock writing a job's
+//  termination event to the state callback reporting it Done, and the rate
+//  of asynchronous cancels. The mock directory (mock_condor, by default) is
+//  put first in PATH, so binary_path in the adaptor's configuration should
+//  be left empty, or point at it. Its state is reset on every run.
+
+#include "test_helpers.hpp"
+
+#include <saga/saga.hpp>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using saga::adaptors::condor::test::now;
+using saga::adaptors::condor::test::percentile;
+
+//  Records when jobs are reported Done, by cluster.
+struct done_times
+{
+    void set(std::string const & cluster_id, double time)
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+        times_.insert(std::make_pair(cluster_id, time));
+    }
+
+    std::map<std::string, double> get() const
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+        return times_;
+    }
+
+private:
+    mutable boost::mutex mtx_;
+    std::map<std::string, double> times_;
+};
+
+struct state_callback
+{
+    state_callback(done_times & times, std::string const & cluster_id)
+        : times_(&times)
+        , cluster_id_(cluster_id)
+    {
+    }
+
+    bool operator()(saga::object, saga::metric m, saga::context)
+    {
+        double const time = now();
+        if ("Done" == m.get_attribute(saga::attributes::metric_value))
+            times_->set(cluster_id_, time);
+        return true;
+    }
+
+private:
+    done_times * times_;
+    std::string cluster_id_;
+};
+
+//  "[condor://localhost]-[12]" -> "12"
+std::string get_cluster_id(saga::job::job & job)
+{
+    std::string const id = job.get_job_id();
+    std::string::size_type const begin = id.rfind('[');
+    std::string::size_type const end = id.rfind(']');
+    if (std::string::npos == begin || std::string::npos == end || end < begin)
+        return std::string();
+    return id.substr(begin + 1, end - begin - 1);
+}
+
+void write_config(std::string const & state, std::string const & settings)
+{
+    std::ofstream os((state + "/config").c_str());
+    os << settings;
+}
+
+void reset_state(std::string const & state)
+{
+    char const * const files[] = { "queue", "history", "events",
+        "next_cluster" };
+    for (std::size_t i = 0; i < sizeof(files) / sizeof(*files); ++i)
+        std::remove((state + "/" + files[i]).c_str());
+}
+
+int main(int argc, char * argv[])
+{
+    using namespace saga::job::attributes;
+
+    std::string mock = argc > 1 ? argv[1] : "mock_condor";
+    std::size_t const jobs = argc > 2
+        ? boost::lexical_cast<std::size_t>(argv[2]) : 100;
+    std::size_t const cancels = argc > 3
+        ? boost::lexical_cast<std::size_t>(argv[3]) : 50;
+
+    if (access((mock + "/condor_submit").c_str(), X_OK))
+    {
+        std::cout << "Mock Condor tools not found in " << mock
+            << ". Build them with make -C " << mock << ".\n";
+        return 0;
+    }
+
+    if ('/' != mock[0])
+    {
+        char cwd[4096];
+        if (getcwd(cwd, sizeof(cwd)))
+            mock = std::string(cwd) + "/" + mock;
+    }
+
+    std::string path = mock;
+    if (char const * old_path = std::getenv("PATH"))
+        path += std::string(":") + old_path;
+    setenv("PATH", path.c_str(), 1);
+
+    // The adaptor may not pass MOCK_CONDOR_DIR on, the default is used.
+    std::string const state = mock + "/state";
+    unsetenv("MOCK_CONDOR_DIR");
+    mkdir(state.c_str(), 0755);
+    reset_state(state);
+
+    write_config(state,
+        "queue_delay = 0.5\n"
+        "run_time = 1\n"
+        "jitter = 0.5\n");
+
+    saga::job::description jd;
+    jd.set_attribute(description_executable, "/bin/true");
+
+    try
+    {
+        saga::job::service js("condor://localhost");
+
+        ////////////////////////////////////////////////////////////////////////
+        // Submission and notification latency
+
+        done_times done;
+        std::vector<saga::job::job> submitted;
+        submitted.reserve(jobs);
+
+        double const submit_start = now();
+        for (std::size_t i = 0; i < jobs; ++i)
+        {
+            saga::job::job job = js.create_job(jd);
+            job.run();
+
+            job.add_callback(saga::job::metrics::state,
+                state_callback(done, get_cluster_id(job)));
+            submitted.push_back(job);
+        }
+        double const submit_time = now() - submit_start;
+
+        for (std::size_t i = 0; i < submitted.size(); ++i)
+            submitted[i].wait(-1.0);
+
+        // Give the last callbacks a moment.
+        boost::xtime t;
+        boost::xtime_get(&t, boost::TIME_UTC);
+        t.sec += 1;
+        boost::thread::sleep(t);
+
+        // Termination events, by cluster.
+        std::map<std::string, double> terminated;
+        {
+            std::ifstream is((state + "/events").c_str());
+            std::string cluster_id, proc;
+            int type;
+            double time;
+            while (is >> cluster_id >> proc >> type >> time)
+                if (5 == type)
+                    terminated[cluster_id] = time;
+        }
+
+        std::vector<double> latencies;
+        std::map<std::string, double> const reported = done.get();
+        std::map<std::string, double>::const_iterator end = reported.end();
+        for (std::map<std::string, double>::const_iterator it
+                = reported.begin(); it != end; ++it)
+        {
+            std::map<std::string, double>::const_iterator event
+                = terminated.find((*it).first);
+            if (terminated.end() != event)
+                latencies.push_back((*it).second - (*event).second);
+        }
+        std::sort(latencies.begin(), latencies.end());
+
+        std::cout << "Submitted " << jobs << " jobs in " << submit_time
+            << " s: " << jobs / submit_time << " submissions/s\n";
+
+        std::cout << "Done notified for " << latencies.size() << " of "
+            << jobs << " jobs. Latency (ms): p50 "
+            << 1e3 * percentile(latencies, 0.5) << ", p90 "
+            << 1e3 * percentile(latencies, 0.9) << ", p99 "
+            << 1e3 * percentile(latencies, 0.99) << ", max "
+            << 1e3 * (latencies.empty() ? 0. : latencies.back()) << "\n";
+
+        ////////////////////////////////////////////////////////////////////////
+        // Cancel throughput
+
+        write_config(state,
+            "queue_delay = 0.1\n"
+            "run_time = 3600\n");
+
+        std::vector<saga::job::job> running;
+        running.reserve(cancels);
+        for (std::size_t i = 0; i < cancels; ++i)
+        {
+            saga::job::job job = js.create_job(jd);
+            job.run();
+            running.push_back(job);
+        }
+
+        double const cancel_start = now();
+
+        std::vector<saga::task> tasks;
+        tasks.reserve(cancels);
+        for (std::size_t i = 0; i < running.size(); ++i)
+            tasks.push_back(running[i].cancel<saga::task_base::Async>());
+
+        for (std::size_t i = 0; i < tasks.size(); ++i)
+            tasks[i].wait();
+        for (std::size_t i = 0; i < running.size(); ++i)
+            running[i].wait(-1.0);
+
+        double const cancel_time = now() - cancel_start;
+
+        std::cout << "Canceled " << cancels << " jobs in " << cancel_time
+            << " s: " << cancels / cancel_time << " cancels/s\n";
+    }
+    catch (saga::exception const & e)
+    {
+        std::cerr << "Benchmark failed. Is the Condor adaptor installed, with "
+            "binary_path empty or pointing at " << mock << "?\n\n"
+            "Error message follows:\n" << e.what();
+
+        // As in condor-demo, don't fail where the adaptor isn't configured.
+        return 0;
+    }
+}
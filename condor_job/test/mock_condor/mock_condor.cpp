@@ -0,0 +1,1205 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+//
+//  Stand-in for the Condor command-line tools, for running the adaptor, and
+//  benchmarks, without a Condor pool. The tool run is picked from the name
+//  the binary is invoked as: condor_submit, condor_q, condor_rm, condor_hold,
+//  condor_release or condor_history (see the Makefile for the links). Point
+//  the adaptor's binary_path at this directory, or put it first in PATH.
+//
+//  The queue and history are kept in a state directory, $MOCK_CONDOR_DIR, or
+//  "state" next to the binary. condor_submit starts a background schedd that
+//  moves jobs from idle to running to completed, writing XML job log events
+//  as it goes, and exits once the queue has been empty for a while.
+//
+//  Behaviour is set in the "config" file of the state directory, as
+//  "key = value" lines (times in seconds):
+//
+//      queue_delay          Time jobs stay idle (0.5)
+//      run_time             Time jobs run (1.0)
+//      jitter               Times vary randomly by this fraction (0.5)
+//      command_delay        Time each command takes to respond (0)
+//      submit_failure_rate  Fraction of condor_submit calls failing (0)
+//      job_failure_rate     Fraction of jobs exiting with code 1 (0)
+//      tick                 Period of the schedd (0.05)
+//      idle_timeout         Time the schedd stays up without jobs (10)
+//
+//  Besides the job logs, every event is appended to the "events" file of the
+//  state directory, as "cluster proc event-type time" with sub-second times,
+//  for measuring notification latency.
+//
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <pwd.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+    // JobStatus
+    enum { idle = 1, running = 2, removed = 3, completed = 4, held = 5 };
+
+    // EventTypeNumber
+    enum { submit_event = 0, execute_event = 1, terminated_event = 5,
+        aborted_event = 9, held_event = 12, released_event = 13 };
+
+    double now()
+    {
+        timeval tv;
+        gettimeofday(&tv, 0);
+        return tv.tv_sec + tv.tv_usec / 1e6;
+    }
+
+    void sleep_for(double seconds)
+    {
+        if (seconds > 0.)
+            usleep(static_cast<useconds_t>(seconds * 1e6));
+    }
+
+    double random_fraction()
+    {
+        return std::rand() / (RAND_MAX + 1.);
+    }
+
+    std::string to_string(double value)
+    {
+        std::ostringstream os;
+        os.precision(17);
+        os << value;
+        return os.str();
+    }
+
+    std::string to_string(long value)
+    {
+        std::ostringstream os;
+        os << value;
+        return os.str();
+    }
+
+    std::string trim(std::string const & str)
+    {
+        std::string::size_type const begin = str.find_first_not_of(" \t\r\n");
+        if (std::string::npos == begin)
+            return std::string();
+        return str.substr(begin,
+            str.find_last_not_of(" \t\r\n") - begin + 1);
+    }
+
+    std::string to_lower(std::string str)
+    {
+        for (std::size_t i = 0; i < str.size(); ++i)
+            str[i] = std::tolower(static_cast<unsigned char>(str[i]));
+        return str;
+    }
+
+    bool is_number(std::string const & str)
+    {
+        return !str.empty()
+            && std::string::npos == str.find_first_not_of("0123456789");
+    }
+
+    // Strings in state files are single words.
+    std::string encode(std::string const & str)
+    {
+        if (str.empty())
+            return "%";
+
+        std::string result;
+        for (std::size_t i = 0; i < str.size(); ++i)
+        {
+            char const c = str[i];
+            if ('%' == c || ' ' == c || '\t' == c || '\n' == c || '\r' == c)
+            {
+                char buffer[4];
+                std::sprintf(buffer, "%%%02X", static_cast<unsigned char>(c));
+                result += buffer;
+            }
+            else
+                result += c;
+        }
+        return result;
+    }
+
+    std::string decode(std::string const & str)
+    {
+        std::string result;
+        for (std::size_t i = 0; i < str.size(); ++i)
+        {
+            if ('%' == str[i] && i + 2 < str.size())
+            {
+                result += static_cast<char>(
+                    std::strtol(str.substr(i + 1, 2).c_str(), 0, 16));
+                i += 2;
+            }
+            else if ('%' != str[i])
+                result += str[i];
+        }
+        return result;
+    }
+
+    std::string escape_xml(std::string const & str)
+    {
+        std::string result;
+        for (std::size_t i = 0; i < str.size(); ++i)
+        {
+            switch (str[i])
+            {
+            case '&': result += "&amp;"; break;
+            case '<': result += "&lt;"; break;
+            case '>': result += "&gt;"; break;
+            case '"': result += "&quot;"; break;
+            default: result += str[i];
+            }
+        }
+        return result;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+
+    struct config
+    {
+        config()
+            : queue_delay(0.5)
+            , run_time(1.)
+            , jitter(0.5)
+            , command_delay(0.)
+            , submit_failure_rate(0.)
+            , job_failure_rate(0.)
+            , tick(0.05)
+            , idle_timeout(10.)
+        {
+        }
+
+        void load(std::string const & file)
+        {
+            std::ifstream is(file.c_str());
+            for (std::string line; std::getline(is, line); )
+            {
+                std::string::size_type const eq = line.find('=');
+                if (std::string::npos == eq)
+                    continue;
+
+                std::string const key = trim(line.substr(0, eq));
+                double const value
+                    = std::atof(trim(line.substr(eq + 1)).c_str());
+
+                if ("queue_delay" == key) queue_delay = value;
+                else if ("run_time" == key) run_time = value;
+                else if ("jitter" == key) jitter = value;
+                else if ("command_delay" == key) command_delay = value;
+                else if ("submit_failure_rate" == key)
+                    submit_failure_rate = value;
+                else if ("job_failure_rate" == key) job_failure_rate = value;
+                else if ("tick" == key) tick = value;
+                else if ("idle_timeout" == key) idle_timeout = value;
+            }
+        }
+
+        double vary(double value) const
+        {
+            return value * (1. + jitter * (2. * random_fraction() - 1.));
+        }
+
+        double queue_delay;
+        double run_time;
+        double jitter;
+        double command_delay;
+        double submit_failure_rate;
+        double job_failure_rate;
+        double tick;
+        double idle_timeout;
+    };
+
+    struct job
+    {
+        job()
+            : cluster(0)
+            , proc(0)
+            , status(idle)
+            , exit_code(0)
+            , qdate(0.)
+            , run_at(0.)
+            , end_at(0.)
+        {
+        }
+
+        std::string get_id() const
+        {
+            return to_string(cluster) + "." + to_string(proc);
+        }
+
+        long cluster;
+        long proc;
+        int status;
+        int exit_code;
+
+        double qdate;
+        double run_at;      // When idle
+        double end_at;      // When running; time left to run, when held
+
+        std::string owner;
+        std::string cmd;
+        std::string session;
+        std::string log;
+    };
+
+    typedef std::vector<job> job_list;
+
+    std::ostream & operator<<(std::ostream & os, job const & j)
+    {
+        return os << j.cluster << ' ' << j.proc << ' ' << j.status << ' '
+            << j.exit_code << ' ' << to_string(j.qdate) << ' '
+            << to_string(j.run_at) << ' ' << to_string(j.end_at) << ' '
+            << encode(j.owner) << ' ' << encode(j.cmd) << ' '
+            << encode(j.session) << ' ' << encode(j.log);
+    }
+
+    std::istream & operator>>(std::istream & is, job & j)
+    {
+        std::string owner, cmd, session, log;
+        if (is >> j.cluster >> j.proc >> j.status >> j.exit_code >> j.qdate
+                >> j.run_at >> j.end_at >> owner >> cmd >> session >> log)
+        {
+            j.owner = decode(owner);
+            j.cmd = decode(cmd);
+            j.session = decode(session);
+            j.log = decode(log);
+        }
+        return is;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+
+    //  State directory, and exclusive access to it.
+    struct state
+    {
+        state()
+            : lock_fd_(-1)
+        {
+            char const * env = std::getenv("MOCK_CONDOR_DIR");
+            if (env && *env)
+                dir_ = env;
+            else
+            {
+                char path[4096];
+                ssize_t const size
+                    = ::readlink("/proc/self/exe", path, sizeof(path) - 1);
+                std::string exe = size > 0 ? std::string(path, size) : ".";
+                std::string::size_type const slash = exe.rfind('/');
+                dir_ = (std::string::npos == slash ? std::string(".")
+                    : exe.substr(0, slash)) + "/state";
+            }
+
+            ::mkdir(dir_.c_str(), 0755);
+            config_.load(get_path("config"));
+        }
+
+        ~state()
+        {
+            unlock();
+        }
+
+        std::string get_path(std::string const & file) const
+        {
+            return dir_ + "/" + file;
+        }
+
+        config const & get_config() const
+        {
+            return config_;
+        }
+
+        void lock()
+        {
+            if (lock_fd_ >= 0)
+                return;
+
+            lock_fd_ = ::open(get_path("lock").c_str(), O_RDWR | O_CREAT, 0644);
+            if (lock_fd_ < 0 || ::flock(lock_fd_, LOCK_EX) < 0)
+            {
+                std::cerr << "ERROR: Can't lock " << get_path("lock") << ": "
+                    << std::strerror(errno) << "\n";
+                std::exit(1);
+            }
+        }
+
+        void unlock()
+        {
+            if (lock_fd_ < 0)
+                return;
+
+            ::close(lock_fd_);
+            lock_fd_ = -1;
+        }
+
+        job_list load(std::string const & file) const
+        {
+            job_list jobs;
+
+            std::ifstream is(get_path(file).c_str());
+            for (std::string line; std::getline(is, line); )
+            {
+                std::istringstream ls(line);
+                job j;
+                if (ls >> j)
+                    jobs.push_back(j);
+            }
+
+            return jobs;
+        }
+
+        void save(std::string const & file, job_list const & jobs) const
+        {
+            std::string const path = get_path(file);
+            std::string const temp = path + ".tmp";
+            {
+                std::ofstream os(temp.c_str());
+                for (std::size_t i = 0; i < jobs.size(); ++i)
+                    os << jobs[i] << "\n";
+            }
+            std::rename(temp.c_str(), path.c_str());
+        }
+
+        void append(std::string const & file, job_list const & jobs) const
+        {
+            std::ofstream os(get_path(file).c_str(), std::ios::app);
+            for (std::size_t i = 0; i < jobs.size(); ++i)
+                os << jobs[i] << "\n";
+        }
+
+        long next_cluster() const
+        {
+            std::string const path = get_path("next_cluster");
+
+            long cluster = 1;
+            {
+                std::ifstream is(path.c_str());
+                is >> cluster;
+            }
+            {
+                std::ofstream os(path.c_str());
+                os << cluster + 1 << "\n";
+            }
+
+            return cluster;
+        }
+
+        //  Writes an event of j to its log, and to the events file.
+        //  Terminated jobs report exit_code.
+        void log_event(job const & j, int type, double time) const
+        {
+            {
+                std::ofstream events(get_path("events").c_str(),
+                    std::ios::app);
+                events << j.cluster << ' ' << j.proc << ' ' << type << ' '
+                    << to_string(time) << "\n";
+            }
+
+            if (j.log.empty())
+                return;
+
+            static char const * const names[] = { "SubmitEvent",
+                "ExecuteEvent", "", "", "", "JobTerminatedEvent", "", "", "",
+                "JobAbortedEvent", "", "", "JobHeldEvent",
+                "JobReleaseEvent" };
+
+            char stamp[32];
+            std::time_t const seconds = static_cast<std::time_t>(time);
+            std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S",
+                std::localtime(&seconds));
+
+            std::string event = "<c>\n"
+                "    <a n=\"MyType\"><s>" + std::string(names[type])
+                    + "</s></a>\n"
+                "    <a n=\"EventTypeNumber\"><i>" + to_string(long(type))
+                    + "</i></a>\n"
+                "    <a n=\"EventTime\"><s>" + stamp + "</s></a>\n"
+                "    <a n=\"Cluster\"><i>" + to_string(j.cluster)
+                    + "</i></a>\n"
+                "    <a n=\"Proc\"><i>" + to_string(j.proc) + "</i></a>\n"
+                "    <a n=\"Subproc\"><i>0</i></a>\n";
+
+            switch (type)
+            {
+            case submit_event:
+                event += "    <a n=\"SubmitHost\"><s>&lt;127.0.0.1:9618&gt;"
+                    "</s></a>\n";
+                break;
+
+            case execute_event:
+                event += "    <a n=\"ExecuteHost\"><s>&lt;127.0.0.1:9619&gt;"
+                    "</s></a>\n";
+                break;
+
+            case terminated_event:
+                event += "    <a n=\"TerminatedNormally\"><b v=\"t\"/></a>\n"
+                    "    <a n=\"ReturnValue\"><i>" + to_string(long(j.exit_code))
+                    + "</i></a>\n";
+                break;
+
+            case held_event:
+                event += "    <a n=\"HoldReason\"><s>via condor_hold</s></a>\n";
+                break;
+            }
+
+            event += "</c>\n";
+
+            int const fd = ::open(j.log.c_str(),
+                O_WRONLY | O_CREAT | O_APPEND, 0644);
+            if (fd < 0)
+                return;
+            ssize_t written = ::write(fd, event.data(), event.size());
+            (void)written;
+            ::close(fd);
+        }
+
+    private:
+        std::string dir_;
+        config config_;
+        int lock_fd_;
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    //  Constraints: comparisons of attributes with integer or string
+    //  literals, combined with &&, || and parentheses.
+
+    typedef std::map<std::string, std::string> attribute_map;
+
+    attribute_map get_attributes(job const & j)
+    {
+        attribute_map attributes;
+        attributes["ClusterId"] = to_string(j.cluster);
+        attributes["ProcId"] = to_string(j.proc);
+        attributes["JobStatus"] = to_string(long(j.status));
+        attributes["QDate"] = to_string(long(j.qdate));
+        attributes["Owner"] = "\"" + j.owner + "\"";
+        attributes["Cmd"] = "\"" + j.cmd + "\"";
+        if (!j.session.empty())
+            attributes["SagaSession"] = "\"" + j.session + "\"";
+        if (!j.log.empty())
+        {
+            attributes["UserLog"] = "\"" + j.log + "\"";
+            attributes["UserLogUseXML"] = "true";
+        }
+        if (removed == j.status || completed == j.status)
+            attributes["ExitCode"] = to_string(long(j.exit_code));
+        return attributes;
+    }
+
+    struct constraint_parser
+    {
+        constraint_parser(std::string const & text,
+                attribute_map const & attributes)
+            : text_(text)
+            , pos_(0)
+            , attributes_(attributes)
+        {
+        }
+
+        bool evaluate()
+        {
+            bool const result = parse_or();
+            skip();
+            return result && pos_ == text_.size();
+        }
+
+    private:
+        void skip()
+        {
+            while (pos_ < text_.size() && std::isspace(
+                    static_cast<unsigned char>(text_[pos_])))
+                ++pos_;
+        }
+
+        bool accept(char const * token)
+        {
+            skip();
+            std::size_t const length = std::strlen(token);
+            if (0 != text_.compare(pos_, length, token))
+                return false;
+            pos_ += length;
+            return true;
+        }
+
+        bool parse_or()
+        {
+            bool result = parse_and();
+            while (accept("||"))
+                result = parse_and() || result;
+            return result;
+        }
+
+        bool parse_and()
+        {
+            bool result = parse_primary();
+            while (accept("&&"))
+                result = parse_primary() && result;
+            return result;
+        }
+
+        bool parse_primary()
+        {
+            if (accept("("))
+            {
+                bool const result = parse_or();
+                accept(")");
+                return result;
+            }
+
+            std::string const name = parse_token();
+
+            std::string op;
+            char const * const ops[] = { "==", "!=", ">=", "<=", ">", "<" };
+            for (std::size_t i = 0; i < sizeof(ops) / sizeof(*ops); ++i)
+                if (accept(ops[i]))
+                {
+                    op = ops[i];
+                    break;
+                }
+
+            std::string const literal = parse_token();
+
+            attribute_map::const_iterator it = attributes_.find(name);
+            if (attributes_.end() == it || op.empty())
+                return false;
+
+            std::string const & value = (*it).second;
+            if (is_number(value) && is_number(literal))
+            {
+                long const l = std::atol(value.c_str());
+                long const r = std::atol(literal.c_str());
+                return ("==" == op && l == r) || ("!=" == op && l != r)
+                    || (">=" == op && l >= r) || ("<=" == op && l <= r)
+                    || (">" == op && l > r) || ("<" == op && l < r);
+            }
+
+            return ("==" == op && value == literal)
+                || ("!=" == op && value != literal);
+        }
+
+        //  An attribute name, number or string literal, quotes included.
+        std::string parse_token()
+        {
+            skip();
+
+            std::size_t const begin = pos_;
+            if (pos_ < text_.size() && '"' == text_[pos_])
+            {
+                std::string literal = "\"";
+                for (++pos_; pos_ < text_.size() && '"' != text_[pos_]; ++pos_)
+                {
+                    if ('\\' == text_[pos_] && pos_ + 1 < text_.size())
+                        ++pos_;
+                    literal += text_[pos_];
+                }
+                ++pos_;
+                return literal + "\"";
+            }
+
+            while (pos_ < text_.size() && (std::isalnum(
+                    static_cast<unsigned char>(text_[pos_]))
+                        || '_' == text_[pos_] || '.' == text_[pos_]))
+                ++pos_;
+            return text_.substr(begin, pos_ - begin);
+        }
+
+        std::string const & text_;
+        std::size_t pos_;
+        attribute_map const & attributes_;
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    //  The schedd.
+
+    //  Moves jobs along, writing events. Finished jobs are moved to
+    //  history. Returns true if anything changed.
+    bool advance(state const & s, job_list & queue, job_list & history,
+        double t)
+    {
+        bool changed = false;
+
+        job_list remaining;
+        for (std::size_t i = 0; i < queue.size(); ++i)
+        {
+            job & j = queue[i];
+
+            if (idle == j.status && t >= j.run_at)
+            {
+                j.status = running;
+                s.log_event(j, execute_event, t);
+                changed = true;
+            }
+
+            if (running == j.status && t >= j.end_at)
+            {
+                j.status = completed;
+                s.log_event(j, terminated_event, t);
+                history.push_back(j);
+                changed = true;
+                continue;
+            }
+
+            remaining.push_back(j);
+        }
+
+        queue.swap(remaining);
+        return changed;
+    }
+
+    void run_schedd(state & s)
+    {
+        double idle_since = now();
+
+        for (;;)
+        {
+            config const & cfg = s.get_config();
+            sleep_for(cfg.tick);
+
+            s.lock();
+
+            job_list queue = s.load("queue");
+            double const t = now();
+
+            if (queue.empty())
+            {
+                if (t - idle_since > cfg.idle_timeout)
+                {
+                    ::unlink(s.get_path("schedd.pid").c_str());
+                    s.unlock();
+                    return;
+                }
+            }
+            else
+            {
+                idle_since = t;
+
+                job_list history;
+                if (advance(s, queue, history, t))
+                {
+                    s.save("queue", queue);
+                    s.append("history", history);
+                }
+            }
+
+            s.unlock();
+        }
+    }
+
+    //  Starts the schedd, unless it is running. Called with the state
+    //  locked.
+    void ensure_schedd(state & s)
+    {
+        std::string const pid_file = s.get_path("schedd.pid");
+        {
+            pid_t pid = 0;
+            std::ifstream is(pid_file.c_str());
+            if (is >> pid && pid > 0 && 0 == ::kill(pid, 0))
+                return;
+        }
+
+        pid_t const child = ::fork();
+        if (child < 0)
+            return;
+
+        if (child > 0)
+        {
+            int status;
+            ::waitpid(child, &status, 0);
+            return;
+        }
+
+        // Detach from our caller, which waits for our output to end.
+        ::setsid();
+        pid_t const schedd = ::fork();
+        if (schedd != 0)
+        {
+            if (schedd > 0)
+            {
+                std::ofstream os(pid_file.c_str());
+                os << schedd << "\n";
+            }
+            ::_exit(0);
+        }
+
+        long const max_fd = ::sysconf(_SC_OPEN_MAX);
+        for (long fd = 0; fd < (max_fd > 0 ? max_fd : 1024); ++fd)
+            ::close(fd);
+
+        int const null = ::open("/dev/null", O_RDWR);
+        if (null >= 0)
+        {
+            ::dup2(null, 0);
+            ::dup2(null, 1);
+            ::dup2(null, 2);
+        }
+
+        state schedd_state;
+        run_schedd(schedd_state);
+        ::_exit(0);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    //  Tools
+
+    std::string get_owner()
+    {
+        passwd const * pw = ::getpwuid(::getuid());
+        return pw ? pw->pw_name : "nobody";
+    }
+
+    int condor_submit(state & s, std::vector<std::string> const & args)
+    {
+        bool terse = false;
+        std::vector<std::string> appended;
+        std::string file;
+
+        for (std::size_t i = 0; i < args.size(); ++i)
+        {
+            if ("-terse" == args[i])
+                terse = true;
+            else if ("-append" == args[i] || "-a" == args[i])
+            {
+                if (++i < args.size())
+                    appended.push_back(args[i]);
+            }
+            else if (!args[i].empty() && '-' != args[i][0])
+                file = args[i];
+        }
+
+        std::ifstream file_stream;
+        if (!file.empty())
+        {
+            file_stream.open(file.c_str());
+            if (!file_stream)
+            {
+                std::cerr << "ERROR: Can't open file " << file << "\n";
+                return 1;
+            }
+        }
+        std::istream & is = file.empty() ? std::cin : file_stream;
+
+        // Description, with -append lines before the first queue statement.
+        std::map<std::string, std::string> attributes;
+        long processes = 0;
+        bool queued = false;
+
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(is, line); )
+            lines.push_back(line);
+
+        for (std::size_t i = 0; i < lines.size(); ++i)
+        {
+            std::string const line = trim(lines[i]);
+            std::string const lower = to_lower(line);
+
+            if (0 == lower.compare(0, 5, "queue")
+                    && (5 == lower.size() || std::isspace(
+                        static_cast<unsigned char>(lower[5]))))
+            {
+                if (!queued)
+                {
+                    for (std::size_t a = 0; a < appended.size(); ++a)
+                        lines.insert(lines.begin() + i + a, appended[a]);
+                    queued = true;
+                    --i;
+                    continue;
+                }
+
+                std::string const rest = trim(line.substr(5));
+                if (rest.empty())
+                    processes += 1;
+                else if (is_number(rest))
+                    processes += std::atol(rest.c_str());
+                else if (!rest.empty() && '(' == rest[rest.size() - 1])
+                {
+                    // One process per item.
+                    for (++i; i < lines.size() && ")" != trim(lines[i]); ++i)
+                        if (!trim(lines[i]).empty())
+                            ++processes;
+                }
+                else
+                    processes += 1;
+                continue;
+            }
+
+            std::string::size_type const eq = line.find('=');
+            if (std::string::npos == eq)
+                continue;
+
+            attributes[to_lower(trim(line.substr(0, eq)))]
+                = trim(line.substr(eq + 1));
+        }
+
+        if (!queued)
+            processes = 0;
+
+        if (!processes)
+        {
+            std::cerr << "ERROR: No queue statement in submit description\n";
+            return 1;
+        }
+
+        if (attributes["executable"].empty())
+        {
+            std::cerr << "ERROR: No 'executable' parameter was provided\n";
+            return 1;
+        }
+
+        config const & cfg = s.get_config();
+        if (random_fraction() < cfg.submit_failure_rate)
+        {
+            std::cerr << "ERROR: Failed to connect to local queue manager\n"
+                "CEDAR:6001:Failed to connect to <127.0.0.1:9618>\n";
+            return 1;
+        }
+
+        std::string session = attributes["+sagasession"];
+        if (session.size() >= 2 && '"' == session[0])
+            session = session.substr(1, session.size() - 2);
+
+        s.lock();
+
+        long const cluster = s.next_cluster();
+        double const t = now();
+
+        job_list queue = s.load("queue");
+        for (long proc = 0; proc < processes; ++proc)
+        {
+            job j;
+            j.cluster = cluster;
+            j.proc = proc;
+            j.qdate = t;
+            j.run_at = t + cfg.vary(cfg.queue_delay);
+            j.end_at = j.run_at + cfg.vary(cfg.run_time);
+            j.exit_code = random_fraction() < cfg.job_failure_rate ? 1 : 0;
+            j.owner = get_owner();
+            j.cmd = attributes["executable"];
+            j.session = session;
+            if (!attributes["log"].empty())
+                j.log = attributes["log"];
+
+            s.log_event(j, submit_event, t);
+            queue.push_back(j);
+        }
+        s.save("queue", queue);
+
+        ensure_schedd(s);
+        s.unlock();
+
+        if (terse)
+            std::cout << cluster << ".0 - " << cluster << "."
+                << processes - 1 << "\n";
+        else
+            std::cout << "Submitting job(s)" << std::string(processes, '.')
+                << "\n" << processes << " job(s) submitted to cluster "
+                << cluster << ".\n";
+
+        return 0;
+    }
+
+    //  Jobs selected by IDs ("Cluster" or "Cluster.Proc") and a
+    //  constraint. All jobs, if neither is given.
+    bool is_selected(job const & j, std::vector<std::string> const & ids,
+        std::string const & constraint)
+    {
+        if (!ids.empty())
+        {
+            bool found = false;
+            for (std::size_t i = 0; i < ids.size() && !found; ++i)
+                found = ids[i] == to_string(j.cluster)
+                    || ids[i] == j.get_id();
+            if (!found)
+                return false;
+        }
+
+        return constraint.empty()
+            || constraint_parser(constraint, get_attributes(j)).evaluate();
+    }
+
+    void print_xml(job const & j)
+    {
+        attribute_map const attributes = get_attributes(j);
+
+        std::cout << "<c>\n"
+            "    <a n=\"MyType\"><s>Job</s></a>\n"
+            "    <a n=\"TargetType\"><s>Machine</s></a>\n";
+
+        attribute_map::const_iterator end = attributes.end();
+        for (attribute_map::const_iterator it = attributes.begin(); it != end;
+                ++it)
+        {
+            std::string const & value = (*it).second;
+
+            std::cout << "    <a n=\"" << (*it).first << "\">";
+            if (!value.empty() && '"' == value[0])
+                std::cout << "<s>"
+                    << escape_xml(value.substr(1, value.size() - 2))
+                    << "</s>";
+            else if ("true" == value || "false" == value)
+                std::cout << "<b v=\"" << value[0] << "\"/>";
+            else
+                std::cout << "<i>" << value << "</i>";
+            std::cout << "</a>\n";
+        }
+
+        std::cout << "</c>\n";
+    }
+
+    void print_af(job const & j, std::vector<std::string> const & names)
+    {
+        attribute_map const attributes = get_attributes(j);
+
+        for (std::size_t i = 0; i < names.size(); ++i)
+        {
+            attribute_map::const_iterator it = attributes.find(names[i]);
+
+            std::string value = attributes.end() == it
+                ? "undefined" : (*it).second;
+            if (!value.empty() && '"' == value[0])
+                value = value.substr(1, value.size() - 2);
+
+            std::cout << (i ? " " : "") << value;
+        }
+        std::cout << "\n";
+    }
+
+    //  condor_q and condor_history: [ids] [-constraint expr] [-match n]
+    //  [-xml | -af attributes...]
+    int condor_query(state & s, std::vector<std::string> const & args,
+        bool history)
+    {
+        std::vector<std::string> ids, names;
+        std::string constraint;
+        bool xml = false;
+        long match = -1;
+
+        for (std::size_t i = 0; i < args.size(); ++i)
+        {
+            std::string const & arg = args[i];
+
+            if ("-xml" == arg)
+                xml = true;
+            else if ("-constraint" == arg && i + 1 < args.size())
+                constraint = args[++i];
+            else if (("-match" == arg || "-limit" == arg)
+                    && i + 1 < args.size())
+                match = std::atol(args[++i].c_str());
+            else if ("-af" == arg || "-autoformat" == arg)
+            {
+                // Attributes follow, up to the next option.
+                while (i + 1 < args.size() && '-' != args[i + 1][0])
+                    names.push_back(args[++i]);
+            }
+            else if (!arg.empty() && '-' != arg[0])
+                ids.push_back(arg);
+        }
+
+        s.lock();
+        job_list jobs = s.load(history ? "history" : "queue");
+        s.unlock();
+
+        // Most recently finished first.
+        if (history)
+            std::reverse(jobs.begin(), jobs.end());
+
+        if (xml)
+            std::cout << "<?xml version=\"1.0\"?>\n"
+                "<!DOCTYPE classads SYSTEM \"classads.dtd\">\n"
+                "<classads>\n";
+        else if (names.empty())
+            std::cout << "\n-- Schedd: mock@localhost : <127.0.0.1:9618>\n"
+                " ID      OWNER    STATUS\n";
+
+        long printed = 0;
+        for (std::size_t i = 0; i < jobs.size(); ++i)
+        {
+            if (match >= 0 && printed >= match)
+                break;
+
+            job const & j = jobs[i];
+            if (!is_selected(j, ids, constraint))
+                continue;
+
+            if (xml)
+                print_xml(j);
+            else if (!names.empty())
+                print_af(j, names);
+            else
+                std::cout << " " << j.get_id() << "  " << j.owner << "  "
+                    << j.status << "\n";
+
+            ++printed;
+        }
+
+        if (xml)
+            std::cout << "</classads>\n";
+
+        return 0;
+    }
+
+    //  condor_rm, condor_hold and condor_release.
+    int condor_act(state & s, std::vector<std::string> const & args,
+        int event)
+    {
+        std::vector<std::string> ids;
+        for (std::size_t i = 0; i < args.size(); ++i)
+            if (!args[i].empty() && '-' != args[i][0])
+                ids.push_back(args[i]);
+
+        if (ids.empty())
+        {
+            std::cerr << "ERROR: No job IDs given\n";
+            return 1;
+        }
+
+        s.lock();
+
+        job_list queue = s.load("queue");
+        job_list remaining, history;
+        std::map<std::string, bool> acted;
+        double const t = now();
+
+        for (std::size_t i = 0; i < queue.size(); ++i)
+        {
+            job j = queue[i];
+
+            std::string id;
+            for (std::size_t k = 0; k < ids.size() && id.empty(); ++k)
+                if (ids[k] == to_string(j.cluster) || ids[k] == j.get_id())
+                    id = ids[k];
+
+            if (id.empty())
+            {
+                remaining.push_back(j);
+                continue;
+            }
+
+            if (aborted_event == event)
+            {
+                j.status = removed;
+                s.log_event(j, aborted_event, t);
+                history.push_back(j);
+                acted[id] = true;
+                continue;
+            }
+
+            if (held_event == event && held != j.status)
+            {
+                // Keep the time left to run.
+                j.end_at = (std::max)(0., j.end_at - (std::max)(t, j.run_at));
+                j.status = held;
+                s.log_event(j, held_event, t);
+                acted[id] = true;
+            }
+            else if (released_event == event && held == j.status)
+            {
+                config const & cfg = s.get_config();
+                j.run_at = t + cfg.vary(cfg.queue_delay);
+                j.end_at = j.run_at + j.end_at;
+                j.status = idle;
+                s.log_event(j, released_event, t);
+                acted[id] = true;
+            }
+            else if (!acted.count(id))
+                acted[id] = false;
+
+            remaining.push_back(j);
+        }
+
+        s.save("queue", remaining);
+        s.append("history", history);
+        s.unlock();
+
+        char const * const verb = aborted_event == event
+            ? "marked for removal" : held_event == event ? "held" : "released";
+        char const * const action = aborted_event == event
+            ? "remove" : held_event == event ? "hold" : "release";
+
+        int result = 0;
+        for (std::size_t i = 0; i < ids.size(); ++i)
+        {
+            std::string const & id = ids[i];
+            bool const is_cluster = std::string::npos == id.find('.');
+
+            if (acted.count(id) && acted[id])
+            {
+                if (is_cluster)
+                    std::cout << "All jobs in cluster " << id << " have been "
+                        << verb << "\n";
+                else
+                    std::cout << "Job " << id << " " << verb << ".\n";
+            }
+            else
+            {
+                std::cerr << "Couldn't find/" << action << " all jobs matching "
+                    << (is_cluster ? "cluster " : "job ") << id << ".\n";
+                result = 1;
+            }
+        }
+
+        return result;
+    }
+
+} // namespace
+
+int main(int argc, char * argv[])
+{
+    std::string tool = argv[0];
+    std::string::size_type const slash = tool.rfind('/');
+    if (std::string::npos != slash)
+        tool = tool.substr(slash + 1);
+
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    // Also runs as "mock_condor <tool> ...".
+    if (0 != tool.compare(0, 7, "condor_") && !args.empty())
+    {
+        tool = args.front();
+        args.erase(args.begin());
+    }
+
+    std::srand(static_cast<unsigned>(now() * 1e6) ^ ::getpid());
+
+    state s;
+    sleep_for(s.get_config().command_delay);
+
+    if ("condor_submit" == tool)
+        return condor_submit(s, args);
+    if ("condor_q" == tool)
+        return condor_query(s, args, false);
+    if ("condor_history" == tool)
+        return condor_query(s, args, true);
+    if ("condor_rm" == tool)
+        return condor_act(s, args, aborted_event);
+    if ("condor_hold" == tool)
+        return condor_act(s, args, held_event);
+    if ("condor_release" == tool)
+        return condor_act(s, args, released_event);
+
+    std::cerr << "mock_condor: Unknown tool '" << tool << "'. Run as "
+        "condor_submit, condor_q, condor_history, condor_rm, condor_hold or "
+        "condor_release.\n";
+    return 1;
+}
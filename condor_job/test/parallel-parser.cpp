@@ -0,0 +1,123 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "../parallel_parser.hpp"
+
+#include "test_helpers.hpp"
+
+#include <boost/lexical_cast.hpp>
+
+#include <iostream>
+
+using saga::adaptors::condor::parallel_parser;
+using saga::adaptors::condor::test::report_checks;
+
+std::string get_cmd(::condor::job::classad const & ca)
+{
+    boost::optional< ::condor::job::classad::value> cmd
+        = ca.get_attribute("Cmd");
+    return cmd ? cmd->value_ : std::string();
+}
+
+int main()
+{
+    std::size_t const jobs = 2000;
+
+    std::vector<std::string> expected;
+    std::string xml = "<?xml version=\"1.0\"?>\n"
+        "<!DOCTYPE classads SYSTEM \"classads.dtd\">\n"
+        "<classads>\n";
+
+    for (std::size_t i = 0; i < jobs; ++i)
+    {
+        std::string const cluster = boost::lexical_cast<std::string>(i / 10);
+        std::string const proc = boost::lexical_cast<std::string>(i % 10);
+        std::string const cmd = "/bin/job-" + cluster + "-" + proc;
+
+        expected.push_back(cmd);
+        xml += "<c>\n"
+            "    <a n=\"MyType\"><s>Job</s></a>\n"
+            "    <a n=\"ClusterId\"><i>" + cluster + "</i></a>\n"
+            "    <a n=\"ProcId\"><i>" + proc + "</i></a>\n"
+            "    <a n=\"Cmd\"><s>" + cmd + "</s></a>\n"
+            "    <a n=\"JobStatus\"><i>1</i></a>\n"
+            "</c>\n";
+    }
+    xml += "</classads>\n";
+
+    // Same results, in the same order, however many threads
+    std::size_t const threads[] = { 1, 2, 3, 8, 64 };
+    for (std::size_t i = 0; i < sizeof(threads) / sizeof(*threads); ++i)
+    {
+        std::vector<std::string> cmds;
+        parallel_parser(threads[i], 1).parse(xml, &get_cmd, cmds);
+
+        CHECK(expected == cmds);
+    }
+
+    // Small buffers are parsed on a single thread, with the same results
+    {
+        std::vector<std::string> cmds;
+        parallel_parser(8).parse(xml, &get_cmd, cmds);
+
+        CHECK(expected == cmds);
+    }
+
+    // Keyed by ClusterId.ProcId
+    {
+        std::map<std::string, std::string> cmds;
+        parallel_parser(4, 1).parse(xml, &get_cmd, cmds);
+
+        CHECK(jobs == cmds.size());
+        CHECK("/bin/job-0-0" == cmds["0.0"]);
+        CHECK("/bin/job-17-3" == cmds["17.3"]);
+        CHECK("/bin/job-199-9" == cmds["199.9"]);
+    }
+
+    // Attributes don't carry over between ClassAds
+    {
+        std::string const mixed = "<classads>\n"
+            "<c>\n"
+            "    <a n=\"ClusterId\"><i>1</i></a>\n"
+            "    <a n=\"ProcId\"><i>0</i></a>\n"
+            "    <a n=\"Cmd\"><s>/bin/first</s></a>\n"
+            "</c>\n"
+            "<c>\n"
+            "    <a n=\"ClusterId\"><i>1</i></a>\n"
+            "    <a n=\"ProcId\"><i>1</i></a>\n"
+            "</c>\n"
+            "<c>\n"
+            "    <a n=\"ClusterId\"><i>2</i></a>\n"
+            "    <a n=\"Cmd\"><s>/bin/no-proc</s></a>\n"
+            "</c>\n"
+            "</classads>\n";
+
+        std::vector<std::string> cmds;
+        parallel_parser(1).parse(mixed, &get_cmd, cmds);
+
+        CHECK(3 == cmds.size());
+        CHECK("/bin/first" == cmds[0]);
+        CHECK(cmds[1].empty());
+        CHECK("/bin/no-proc" == cmds[2]);
+
+        // ClassAds without a ProcId are skipped.
+        std::map<std::string, std::string> keyed;
+        parallel_parser(1).parse(mixed, &get_cmd, keyed);
+
+        CHECK(2 == keyed.size());
+        CHECK("/bin/first" == keyed["1.0"]);
+        CHECK(keyed["1.1"].empty());
+        CHECK(0 == keyed.count("2.1"));
+    }
+
+    // Nothing to parse
+    {
+        std::vector<std::string> cmds;
+        parallel_parser(4, 1).parse(std::string(), &get_cmd, cmds);
+        CHECK(cmds.empty());
+    }
+
+    return report_checks();
+}
@@ -0,0 +1,74 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "../proc_table.hpp"
+
+#include "test_helpers.hpp"
+
+#include <iostream>
+
+int main()
+{
+    using saga::adaptors::condor::proc_table;
+    using saga::adaptors::condor::test::report_checks;
+
+    proc_table procs;
+    CHECK(saga::job::Unknown == procs.get_aggregate_state());
+    CHECK(!procs.is_final());
+
+    procs.resize(100000);
+    CHECK(100000 == procs.size());
+    CHECK(100000 == procs.count(proc_table::idle));
+    CHECK(saga::job::Running == procs.get_aggregate_state());
+
+    // Shrinking is not supported
+    procs.resize(10);
+    CHECK(100000 == procs.size());
+
+    procs.set(0, proc_table::running);
+    procs.set(1, proc_table::done);
+    CHECK(99998 == procs.count(proc_table::idle));
+    CHECK(1 == procs.count(proc_table::running));
+    CHECK(1 == procs.count(proc_table::done));
+    CHECK(saga::job::Running == procs.get_aggregate_state());
+
+    for (std::size_t i = 0; i < procs.size(); ++i)
+        procs.set(i, proc_table::suspended);
+    CHECK(procs.size() == procs.count(proc_table::suspended));
+    CHECK(saga::job::Suspended == procs.get_aggregate_state());
+
+    for (std::size_t i = 0; i < procs.size(); ++i)
+        procs.set(i, proc_table::done);
+    CHECK(procs.is_final());
+    CHECK(saga::job::Done == procs.get_aggregate_state());
+    CHECK(0 == procs.get_aggregate_exit_code());
+
+    procs.set(42, proc_table::canceled);
+    CHECK(saga::job::Canceled == procs.get_aggregate_state());
+
+    procs.set(7, proc_table::failed, 3);
+    procs.set(9, proc_table::done, 5);
+    CHECK(procs.is_final());
+    CHECK(saga::job::Failed == procs.get_aggregate_state());
+    CHECK(3 == procs.get_exit_code(7));
+    CHECK(3 == procs.get_aggregate_exit_code());
+
+    // Exit codes beyond a byte
+    procs.set(11, proc_table::failed, -1073741819);
+    procs.set(7, proc_table::failed, 300);
+    CHECK(300 == procs.get_exit_code(7));
+    CHECK(-1073741819 == procs.get_exit_code(11));
+    CHECK(300 == procs.get_aggregate_exit_code());
+    procs.set(7, proc_table::failed, -1);
+    CHECK(-1 == procs.get_aggregate_exit_code());
+
+    // Late process: grows the table
+    procs.set(100004, proc_table::running);
+    CHECK(100005 == procs.size());
+    CHECK(4 == procs.count(proc_table::idle));
+    CHECK(!procs.is_final());
+
+    return report_checks();
+}
@@ -0,0 +1,104 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "../job_registry.cpp"
+#include "../synchronized.hpp"
+#include "../log_processor.cpp"
+#include "../queue_cache.cpp"
+
+#include "log_generator.hpp"
+#include "test_helpers.hpp"
+
+#include <boost/bind.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using saga::adaptors::condor::job_registry;
+using saga::adaptors::condor::log_processor;
+using saga::adaptors::condor::queue_cache;
+using saga::adaptors::condor::synchronized;
+using saga::adaptors::condor::test::log_generator;
+using saga::adaptors::condor::test::now;
+using saga::adaptors::condor::test::report_checks;
+
+void fetch(int & fetches, std::string const & queue,
+    saga::adaptors::condor::classad_reader::callback const & f)
+{
+    ++fetches;
+
+    std::istringstream is(queue);
+    saga::adaptors::condor::classad_reader(16).read(is, f);
+}
+
+// Whether the snapshot still holds job_id, without retaking it.
+bool is_cached(queue_cache & cache, std::string const & job_id)
+{
+    std::string ads;
+    double taken;
+    return cache.get_job(job_id, ads, taken);
+}
+
+int main()
+{
+    std::string const queue = "<?xml version=\"1.0\"?>\n"
+        "<!DOCTYPE classads SYSTEM \"classads.dtd\">\n"
+        "<classads>\n"
+        "<c>\n"
+        "    <a n=\"ClusterId\"><i>12</i></a>\n"
+        "    <a n=\"ProcId\"><i>0</i></a>\n"
+        "    <a n=\"JobStatus\"><i>2</i></a>\n"
+        "</c>\n"
+        "<c>\n"
+        "    <a n=\"ClusterId\"><i>13</i></a>\n"
+        "    <a n=\"ProcId\"><i>0</i></a>\n"
+        "    <a n=\"JobStatus\"><i>2</i></a>\n"
+        "</c>\n"
+        "</classads>\n";
+
+    int fetches = 0;
+    queue_cache::config config;
+    config.ttl = 3600.;
+
+    boost::shared_ptr<queue_cache> cache(new queue_cache(
+        boost::bind(&fetch, boost::ref(fetches), queue, _1), config));
+
+    CHECK(is_cached(*cache, "12"));
+    CHECK(is_cached(*cache, "13"));
+    CHECK(1 == fetches);
+
+    std::string const filename = "queue-cache-log.log";
+    std::remove(filename.c_str());
+    std::ofstream(filename.c_str()).close();
+
+    // No jobs are registered.
+    synchronized<job_registry> registry;
+
+    // An event for an unregistered cluster invalidates the snapshot
+    {
+        log_processor processor(filename, registry, cache);
+
+        {
+            std::ofstream log(filename.c_str(), std::ios_base::app);
+            log << log_generator().format(5, 12);
+        }
+
+        // The log processor polls the log once a second.
+        double const deadline = now() + 10.;
+        while (is_cached(*cache, "12") && now() < deadline)
+            boost::thread::sleep(
+                saga::adaptors::condor::detail::make_deadline(.05));
+
+        CHECK(!is_cached(*cache, "12"));
+        CHECK(is_cached(*cache, "13"));
+        CHECK(1 == fetches);
+    }
+
+    std::remove(filename.c_str());
+
+    return report_checks();
+}
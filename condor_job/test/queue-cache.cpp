@@ -0,0 +1,125 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "../queue_cache.cpp"
+
+#include "test_helpers.hpp"
+
+#include <boost/bind.hpp>
+
+#include <iostream>
+#include <sstream>
+
+using saga::adaptors::condor::queue_cache;
+using saga::adaptors::condor::test::now;
+using saga::adaptors::condor::test::report_checks;
+
+//  A job's ClassAd, as condor_q prints it or, if projected, as kept in the
+//  cache.
+std::string classad(int cluster, int proc, bool projected = true)
+{
+    std::string const c = boost::lexical_cast<std::string>(cluster);
+    std::string const p = boost::lexical_cast<std::string>(proc);
+
+    return "<c>\n"
+        + std::string(projected ? "" :
+            "    <a n=\"MyType\"><s>Job</s></a>\n")
+        + "    <a n=\"ClusterId\"><i>" + c + "</i></a>\n"
+        + (projected ? "" :
+            "    <a n=\"Environment\"><s>PATH=/bin HOME=/home/u</s></a>\n")
+        + "    <a n=\"ProcId\"><i>" + p + "</i></a>\n"
+        "    <a n=\"JobStatus\"><i>2</i></a>\n"
+        "    <a n=\"UserLog\"><s>/tmp/job.log</s></a>\n"
+        "    <a n=\"UserLogUseXML\"><b v=\"t\"/></a>\n"
+        "</c>";
+}
+
+void fetch(int & fetches, std::string const & queue,
+    saga::adaptors::condor::classad_reader::callback const & f)
+{
+    ++fetches;
+
+    std::istringstream is(queue);
+    saga::adaptors::condor::classad_reader(16).read(is, f);
+}
+
+int main()
+{
+    std::string const queue = "<?xml version=\"1.0\"?>\n"
+        "<!DOCTYPE classads SYSTEM \"classads.dtd\">\n"
+        "<classads>\n"
+        + classad(12, 0, false) + "\n"
+        + classad(12, 1, false) + "\n"
+        + classad(13, 0, false) + "\n"
+        "</classads>\n";
+
+    int fetches = 0;
+    queue_cache::config config;
+    config.ttl = 3600.;
+
+    queue_cache cache(boost::bind(&fetch, boost::ref(fetches), queue, _1),
+        config);
+
+    double const start = now();
+
+    // Lookups share a snapshot, holding the attributes we read
+    {
+        std::string ads;
+        double taken = -1.;
+        CHECK(cache.get_job("13", ads, taken));
+        CHECK(classad(13, 0) + "\n" == ads);
+
+        CHECK(cache.get_job("12.1", ads, taken));
+        CHECK(classad(12, 1) == ads);
+
+        CHECK(cache.get_job("12", ads, taken));
+        CHECK(classad(12, 0) + "\n" + classad(12, 1) + "\n" == ads);
+
+        CHECK(!cache.get_job("12.2", ads, taken));
+        CHECK(!cache.get_job("14", ads, taken));
+
+        CHECK(taken >= start);
+        CHECK(1 == fetches);
+    }
+
+    // Invalidated clusters are dropped until the next snapshot
+    {
+        cache.invalidate("12");
+
+        std::string ads;
+        double taken = -1.;
+        CHECK(!cache.get_job("12.0", ads, taken));
+        CHECK(cache.get_job("13.0", ads, taken));
+        CHECK(1 == fetches);
+    }
+
+    // Snapshots taken before not_before are retaken, once
+    {
+        std::string ads;
+        double taken = -1.;
+        double const not_before = now();
+
+        CHECK(cache.get_job("12.0", ads, taken, not_before));
+        CHECK(taken >= not_before);
+        CHECK(2 == fetches);
+
+        CHECK(cache.get_job("13.0", ads, taken, not_before));
+        CHECK(2 == fetches);
+    }
+
+    // Without caching, lookups miss without fetching
+    {
+        config.ttl = 0.;
+        queue_cache uncached(
+            boost::bind(&fetch, boost::ref(fetches), queue, _1), config);
+
+        std::string ads;
+        double taken = -1.;
+        CHECK(!uncached.get_job("12", ads, taken));
+        CHECK(2 == fetches);
+    }
+
+    return report_checks();
+}
@@ -0,0 +1,334 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+//  Measures contention on the job registry and on per-job synchronization,
+//  e.g.:
+//
+//      registry-contention [jobs [seconds [max-threads [events-per-second]]]]
+//
+//  For 1, 4, 16, ... up to max-threads threads, each operation is run by all
+//  threads for the given time, while a log processor dispatches hold and
+//  release events for the first 64 jobs:
+//
+//      find_job        Looks up a random job in the registry
+//      register_job    Registers, then unregisters, a new job
+//      get_state       Reads a random job's state, under its mutex
+//      sync_wait       Waits for the next state change of one of the
+//                      jobs events are dispatched for
+//
+//  Reports throughput and latency percentiles for each.
+
+#include "../job_registry.cpp"
+#include "../synchronized.hpp"
+#include "../log_processor.cpp"
+
+#include "log_generator.hpp"
+#include "test_helpers.hpp"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using saga::adaptors::condor::detail::make_deadline;
+using saga::adaptors::condor::job_registry;
+using saga::adaptors::condor::log_processor;
+using saga::adaptors::condor::shared_job_data;
+using saga::adaptors::condor::synchronized;
+using saga::adaptors::condor::test::log_generator;
+using saga::adaptors::condor::test::now;
+using saga::adaptors::condor::test::percentile;
+using saga::adaptors::condor::test::report_checks;
+
+typedef std::vector<boost::shared_ptr<shared_job_data> > job_list;
+
+std::size_t const hot_jobs = 64;
+
+enum operation { find_job, register_job, get_state, sync_wait };
+char const * const operation_names[] = { "find_job", "register_job",
+    "get_state", "sync_wait" };
+
+//  Runs an operation in a loop, recording the latency of each call.
+struct worker
+{
+    worker(operation op, std::size_t id, synchronized<job_registry> & r,
+            job_list const & jobs, double const & stop)
+        : op_(op)
+        , id_(id)
+        , registry_(r)
+        , jobs_(jobs)
+        , stop_(stop)
+        , seed_(unsigned(id) * 2654435761u + 1)
+        , failed_(0)
+    {
+        latencies_.reserve(100000);
+    }
+
+    void operator()()
+    {
+        std::size_t i = 0;
+        for (double start = now(); start < stop_; ++i)
+        {
+            switch (op_)
+            {
+            case find_job:
+                if (!synchronized<job_registry>::lock(registry_)->find_job(
+                        jobs_[next() % jobs_.size()]->cluster_id))
+                    ++failed_;
+                break;
+
+            case register_job:
+                {
+                    boost::shared_ptr<shared_job_data> job(
+                        new shared_job_data);
+                    job->cluster_id = "worker"
+                        + boost::lexical_cast<std::string>(id_) + "."
+                        + boost::lexical_cast<std::string>(i);
+
+                    synchronized<job_registry>::lock(registry_)
+                        ->register_job(job);
+                    synchronized<job_registry>::lock(registry_)
+                        ->unregister_job(job);
+                }
+                break;
+
+            case get_state:
+                {
+                    shared_job_data & job = *jobs_[next() % jobs_.size()];
+                    shared_job_data::scoped_lock lock(job.state_change_mtx);
+                    if (saga::job::Unknown == job.state)
+                        ++failed_;
+                }
+                break;
+
+            case sync_wait:
+                {
+                    shared_job_data & job = *jobs_[next() % hot_jobs];
+                    shared_job_data::scoped_lock lock(job.state_change_mtx);
+
+                    saga::job::state const state = job.state;
+                    while (state == job.state && now() < stop_)
+                        job.state_change.timed_wait(lock, make_deadline(1.));
+
+                    // Not counted, if the run ended first.
+                    if (state == job.state)
+                        return;
+                }
+                break;
+            }
+
+            double const end = now();
+            latencies_.push_back(end - start);
+            start = end;
+        }
+    }
+
+    std::vector<double> const & get_latencies() const
+    {
+        return latencies_;
+    }
+
+    // Jobs not found, or found in an Unknown state.
+    std::size_t get_failed() const
+    {
+        return failed_;
+    }
+
+private:
+    unsigned next()
+    {
+        seed_ = seed_ * 1103515245u + 12345u;
+        return seed_ >> 8;
+    }
+
+    operation op_;
+    std::size_t id_;
+    synchronized<job_registry> & registry_;
+    job_list const & jobs_;
+    double const & stop_;
+    unsigned seed_;
+
+    std::vector<double> latencies_;
+    std::size_t failed_;
+};
+
+//  Appends hold and release events for the hot jobs to the log, at a
+//  steady rate.
+struct event_writer
+{
+    event_writer(std::string const & filename, double rate)
+        : fd_(::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644))
+        , rate_(rate)
+        , stop_(false)
+    {
+        log_generator::config config;
+        config.clusters = hot_jobs;
+        config.events = std::size_t(-1) / 2;
+        config.set_mix("12:1,13:1");
+        generator_.reset(new log_generator(config));
+    }
+
+    ~event_writer()
+    {
+        if (fd_ >= 0)
+            ::close(fd_);
+    }
+
+    void stop()
+    {
+        boost::mutex::scoped_lock lock(mtx_);
+        stop_ = true;
+    }
+
+    void operator()()
+    {
+        double const start = now();
+        std::size_t written = 0;
+
+        std::string record;
+        int type;
+        std::size_t cluster;
+
+        for (;;)
+        {
+            {
+                boost::mutex::scoped_lock lock(mtx_);
+                if (stop_)
+                    return;
+            }
+
+            // Catch up with the rate, then sleep for 10 ms.
+            std::string batch;
+            std::size_t const due = std::size_t((now() - start) * rate_);
+            for (; written < due && generator_->next(record, type, cluster);
+                    ++written)
+                batch += record;
+
+            if (!batch.empty())
+            {
+                ssize_t const n = ::write(fd_, batch.data(), batch.size());
+                (void)n;
+            }
+
+            boost::thread::sleep(make_deadline(.01));
+        }
+    }
+
+private:
+    int fd_;
+    double rate_;
+    boost::scoped_ptr<log_generator> generator_;
+
+    boost::mutex mtx_;
+    bool stop_;
+};
+
+int main(int argc, char const ** argv)
+{
+    std::size_t const job_count = (std::max)(hot_jobs, argc > 1
+        ? boost::lexical_cast<std::size_t>(argv[1]) : 10000);
+    double const seconds = argc > 2
+        ? boost::lexical_cast<double>(argv[2]) : 0.25;
+    std::size_t const max_threads = argc > 3
+        ? boost::lexical_cast<std::size_t>(argv[3]) : 64;
+    double const rate = argc > 4
+        ? boost::lexical_cast<double>(argv[4]) : 5000.;
+
+    synchronized<job_registry> registry;
+    job_list jobs;
+    jobs.reserve(job_count);
+    for (std::size_t i = 1; i <= job_count; ++i)
+    {
+        boost::shared_ptr<shared_job_data> job(new shared_job_data);
+        job->state = saga::job::Running;
+        job->cluster_id = boost::lexical_cast<std::string>(i);
+
+        synchronized<job_registry>::lock(registry)->register_job(job);
+        jobs.push_back(job);
+    }
+
+    std::string const filename = "registry-contention.log";
+    std::remove(filename.c_str());
+
+    event_writer writer(filename, rate);
+    {
+        log_processor processor(filename, registry);
+        boost::thread writer_thread(boost::ref(writer));
+
+        std::cout << job_count << " jobs, " << rate << " events/s\n"
+            << std::setw(8) << "threads" << std::setw(14) << "operation"
+            << std::setw(12) << "ops/s" << std::setw(10) << "p50 us"
+            << std::setw(10) << "p99 us" << std::setw(10) << "max us"
+            << "\n";
+
+        std::vector<std::size_t> thread_counts;
+        for (std::size_t threads = 1; threads < max_threads; threads *= 4)
+            thread_counts.push_back(threads);
+        thread_counts.push_back(max_threads);
+
+        for (std::size_t t = 0; t < thread_counts.size(); ++t)
+        {
+            std::size_t const threads = thread_counts[t];
+
+            for (int op = find_job; op <= sync_wait; ++op)
+            {
+                double stop = now() + seconds;
+
+                std::vector<boost::shared_ptr<worker> > workers;
+                boost::thread_group group;
+                for (std::size_t i = 0; i < threads; ++i)
+                {
+                    workers.push_back(boost::shared_ptr<worker>(new worker(
+                        operation(op), i, registry, jobs, stop)));
+                    group.create_thread(boost::ref(*workers.back()));
+                }
+                group.join_all();
+
+                std::vector<double> latencies;
+                for (std::size_t i = 0; i < threads; ++i)
+                {
+                    latencies.insert(latencies.end(),
+                        workers[i]->get_latencies().begin(),
+                        workers[i]->get_latencies().end());
+                    CHECK(0 == workers[i]->get_failed());
+                }
+                std::sort(latencies.begin(), latencies.end());
+
+                std::cout << std::setw(8) << threads << std::setw(14)
+                    << operation_names[op] << std::fixed
+                    << std::setprecision(0) << std::setw(12)
+                    << latencies.size() / seconds << std::setprecision(1)
+                    << std::setw(10) << 1e6 * percentile(latencies, 0.5)
+                    << std::setw(10) << 1e6 * percentile(latencies, 0.99)
+                    << std::setw(10)
+                    << 1e6 * (latencies.empty() ? 0. : latencies.back())
+                    << "\n" << std::flush;
+            }
+        }
+
+        writer.stop();
+        writer_thread.join();
+    }
+
+    // Workers' jobs are gone, the others are all there.
+    {
+        std::vector<boost::shared_ptr<shared_job_data> > registered;
+        synchronized<job_registry>::lock(registry)->get_jobs(registered);
+        CHECK(job_count == registered.size());
+    }
+
+    std::remove(filename.c_str());
+
+    return report_checks();
+}
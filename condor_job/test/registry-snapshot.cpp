@@ -0,0 +1,140 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "../job_registry.cpp"
+
+#include "test_helpers.hpp"
+
+#include <iostream>
+#include <string>
+
+using namespace saga::adaptors::condor;
+
+boost::shared_ptr<shared_job_data> make_job(std::string const & cluster,
+    saga::job::state state)
+{
+    boost::shared_ptr<shared_job_data> job(new shared_job_data);
+    job->cluster_id = cluster;
+    job->full_job_id = "[condor://localhost]-[" + cluster + "]";
+    job->state = state;
+    return job;
+}
+
+int main()
+{
+    job_registry registry;
+
+    boost::shared_ptr<shared_job_data> done
+        = make_job("1", saga::job::Done);
+    done->attributes[saga::job::attributes::exitcode] = "7";
+    registry.register_job(done);
+
+    // Registered twice, e.g., a DAG node under its node name.
+    boost::shared_ptr<shared_job_data> running
+        = make_job("2", saga::job::Running);
+    registry.register_job(running);
+    registry.register_job("SAGA1_0_node", running);
+
+    boost::shared_ptr<shared_job_data> cluster
+        = make_job("3", saga::job::Running);
+    cluster->procs.resize(2);
+    cluster->procs.set(1, proc_table::failed, 2);
+    registry.register_job(cluster);
+
+    // Not submitted yet.
+    boost::shared_ptr<shared_job_data> pending(new shared_job_data);
+    registry.register_job("SAGA1_0_other", pending);
+
+    std::vector<job_summary> all;
+    registry.snapshot(all);
+    CHECK(5 == all.size());
+
+    std::set<std::string> ids;
+    for (std::size_t i = 0; i < all.size(); ++i)
+        ids.insert(all[i].job_id);
+    CHECK(5 == ids.size());
+    CHECK(ids.count("[condor://localhost]-[3.0]"));
+    CHECK(ids.count("[condor://localhost]-[3.1]"));
+
+    std::vector<job_summary> subset;
+    std::set<std::string> wanted;
+    wanted.insert("[condor://localhost]-[1]");
+    wanted.insert("[condor://localhost]-[3.1]");
+    wanted.insert("[condor://localhost]-[42]");
+    registry.snapshot(subset, wanted);
+    CHECK(2 == subset.size());
+    for (std::size_t i = 0; i < subset.size(); ++i)
+    {
+        CHECK(subset[i].finished);
+        if ("[condor://localhost]-[1]" == subset[i].job_id)
+        {
+            CHECK(saga::job::Done == subset[i].state);
+            CHECK(7 == subset[i].exit_code);
+        }
+        else
+        {
+            CHECK(saga::job::Failed == subset[i].state);
+            CHECK(2 == subset[i].exit_code);
+        }
+    }
+
+    std::vector<job_summary> active;
+    std::set<saga::job::state> states;
+    states.insert(saga::job::Running);
+    registry.snapshot(active, std::set<std::string>(), states);
+    CHECK(3 == active.size());
+    for (std::size_t i = 0; i < active.size(); ++i)
+        CHECK(!active[i].finished);
+
+    // States are as last recorded, not read from the jobs
+    {
+        shared_job_data::scoped_lock lock(running->state_change_mtx);
+        running->state = saga::job::Done;
+
+        std::vector<job_summary> before;
+        registry.snapshot(before, std::set<std::string>(), states);
+        CHECK(3 == before.size());
+
+        registry.update_summary(*running);
+
+        std::vector<job_summary> after;
+        registry.snapshot(after, std::set<std::string>(), states);
+        CHECK(2 == after.size());
+    }
+
+    // A single process is updated on its own
+    {
+        shared_job_data::scoped_lock lock(cluster->state_change_mtx);
+        cluster->procs.set(0, proc_table::done, 0);
+        cluster->state = cluster->procs.get_aggregate_state();
+        registry.update_summary(*cluster, 0);
+
+        std::vector<job_summary> procs;
+        wanted.clear();
+        wanted.insert("[condor://localhost]-[3]");
+        wanted.insert("[condor://localhost]-[3.0]");
+        registry.snapshot(procs, wanted);
+        CHECK(2 == procs.size());
+        for (std::size_t i = 0; i < procs.size(); ++i)
+            CHECK(procs[i].finished);
+    }
+
+    // Submitted once registered under its Cluster ID, e.g., a DAG node
+    {
+        shared_job_data::scoped_lock lock(pending->state_change_mtx);
+        pending->cluster_id = "4";
+        pending->full_job_id = "[condor://localhost]-[4]";
+        pending->state = saga::job::Running;
+        registry.register_job(pending);
+
+        std::vector<job_summary> submitted;
+        registry.snapshot(submitted,
+            std::set<std::string>(&pending->full_job_id,
+                &pending->full_job_id + 1));
+        CHECK(1 == submitted.size());
+    }
+
+    return test::report_checks();
+}
@@ -0,0 +1,156 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+//  Checks process_launcher, and measures the latency of starting short-lived
+//  commands with it, against fork/exec, e.g.:
+//
+//      spawn-latency [spawns [ballast-MB]]
+//
+//  Ballast is memory allocated and touched before spawning, standing in for
+//  a large application. fork copies its page tables, posix_spawn shouldn't.
+
+#include "../process.cpp"
+
+#include "test_helpers.hpp"
+
+#include <boost/lexical_cast.hpp>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using saga::adaptors::condor::child_process;
+using saga::adaptors::condor::process_launcher;
+using saga::adaptors::condor::process_status;
+using saga::adaptors::condor::test::now;
+using saga::adaptors::condor::test::report_checks;
+
+void fork_exec(char const * path)
+{
+    pid_t pid = fork();
+    if (0 == pid)
+    {
+        char * const argv[] = { const_cast<char *>(path), 0 };
+        execve(path, argv, environ);
+        _exit(127);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+}
+
+int main(int argc, char * argv[])
+{
+    std::size_t const spawns = argc > 1
+        ? boost::lexical_cast<std::size_t>(argv[1]) : 200;
+    std::size_t const ballast_mb = argc > 2
+        ? boost::lexical_cast<std::size_t>(argv[2]) : 0;
+
+    process_launcher launcher;
+
+    // Input is passed through
+    {
+        child_process c = launcher.start("cat", std::vector<std::string>(),
+            process_launcher::redirect_stream,
+            process_launcher::redirect_stream,
+            process_launcher::close_stream);
+
+        c.get_stdin() << "Cluster 42\n" << std::flush;
+        c.close_stdin();
+
+        std::string line;
+        CHECK(std::getline(c.get_stdout(), line));
+        CHECK("Cluster 42" == line);
+        CHECK(!std::getline(c.get_stdout(), line));
+
+        process_status status = c.wait();
+        CHECK(status.exited());
+        CHECK(0 == status.exit_status());
+    }
+
+    // Exit status, and stderr merged into stdout
+    {
+        std::vector<std::string> args;
+        args.push_back("-c");
+        args.push_back("echo failed >&2; exit 3");
+
+        child_process c = launcher.start("sh", args,
+            process_launcher::close_stream,
+            process_launcher::redirect_stream,
+            process_launcher::close_stream);
+
+        std::string line;
+        CHECK(std::getline(c.get_stdout(), line));
+        CHECK("failed" == line);
+
+        process_status status = c.wait();
+        CHECK(status.exited());
+        CHECK(3 == status.exit_status());
+    }
+
+    // Environment
+    {
+        process_launcher custom;
+        custom.set_environment("CONDOR_CONFIG", "/dev/null");
+
+        std::vector<std::string> args;
+        args.push_back("-c");
+        args.push_back("echo \"$CONDOR_CONFIG:$HOME\"");
+
+        child_process c = custom.start("/bin/sh", args,
+            process_launcher::close_stream,
+            process_launcher::redirect_stream,
+            process_launcher::close_stream);
+
+        std::string line;
+        CHECK(std::getline(c.get_stdout(), line));
+        CHECK("/dev/null:" == line);
+        c.wait();
+    }
+
+    // Missing executables
+    {
+        bool thrown = false;
+        try
+        {
+            launcher.start("condor_nonexistent", std::vector<std::string>(),
+                process_launcher::close_stream,
+                process_launcher::close_stream,
+                process_launcher::close_stream);
+        }
+        catch (std::exception const &)
+        {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+
+    // Latency
+    std::vector<char> ballast(ballast_mb * 1024 * 1024);
+    for (std::size_t i = 0; i < ballast.size(); i += 4096)
+        ballast[i] = 1;
+
+    double start = now();
+    for (std::size_t i = 0; i < spawns; ++i)
+        launcher.start("true", std::vector<std::string>(),
+            process_launcher::close_stream,
+            process_launcher::redirect_stream,
+            process_launcher::close_stream).wait();
+    double const spawn_time = now() - start;
+
+    start = now();
+    for (std::size_t i = 0; i < spawns; ++i)
+        fork_exec("/bin/true");
+    double const fork_time = now() - start;
+
+    std::cout << spawns << " spawns, " << ballast_mb << " MB ballast:\n"
+        "  process_launcher: " << 1e6 * spawn_time / spawns << " us/spawn\n"
+        "  fork/exec:        " << 1e6 * fork_time / spawns << " us/spawn\n";
+
+    return report_checks();
+}
@@ -0,0 +1,62 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "../status_poller.hpp"
+
+#include "test_helpers.hpp"
+
+#include <iostream>
+
+using saga::adaptors::condor::status_poller;
+using saga::adaptors::condor::test::report_checks;
+
+int main()
+{
+    // Arguments
+    {
+        std::vector<std::string> clusters;
+        clusters.push_back("12");
+        clusters.push_back("15");
+
+        std::vector<std::string> args
+            = status_poller::get_arguments(clusters);
+        CHECK(7 == args.size());
+        CHECK(args.size() == 7 && "-constraint" == args[0]
+            && "ClusterId == 12 || ClusterId == 15" == args[1]
+            && "-af" == args[2] && "ExitCode" == args[6]);
+    }
+
+    // Running job, no exit code yet
+    {
+        status_poller::entry e;
+        CHECK(status_poller::parse_line("1234 3 2 undefined", e));
+        CHECK("1234" == e.cluster_id);
+        CHECK(3 == e.proc);
+        CHECK(2 == e.status);
+        CHECK(0 == e.exit_code);
+    }
+
+    // Completed job
+    {
+        status_poller::entry e;
+        CHECK(status_poller::parse_line("17 0 4 42", e));
+        CHECK("17" == e.cluster_id);
+        CHECK(0 == e.proc);
+        CHECK(4 == e.status);
+        CHECK(42 == e.exit_code);
+    }
+
+    // Not job lines
+    {
+        status_poller::entry e;
+        CHECK(!status_poller::parse_line("", e));
+        CHECK(!status_poller::parse_line("17 0 4", e));
+        CHECK(!status_poller::parse_line("-- Schedd: host : <1.2.3.4>", e));
+        CHECK(!status_poller::parse_line("17.0 0 4 0", e));
+        CHECK(!status_poller::parse_line("17 x 4 0", e));
+    }
+
+    return report_checks();
+}
@@ -0,0 +1,79 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "../submit_governor.hpp"
+
+#include "test_helpers.hpp"
+
+#include <iostream>
+
+int main()
+{
+    using saga::adaptors::condor::submit_governor;
+    using saga::adaptors::condor::test::report_checks;
+
+    CHECK(submit_governor::is_transient(
+        "ERROR: Failed to connect to local queue manager"));
+    CHECK(submit_governor::is_transient("CEDAR:6001:Connection timed out"));
+    CHECK(!submit_governor::is_transient(
+        "ERROR: Executable file /bin/nonexistent does not exist"));
+
+    submit_governor::config config;
+    config.max_rate = 8.;
+    config.min_rate = 1.;
+    config.rate_increase = 1.;
+    config.target_latency = 1.;
+    config.max_retries = 3;
+    config.backoff = 2.;
+    config.max_backoff = 5.;
+
+    submit_governor governor(config);
+    CHECK(8. == governor.get_rate());
+
+    // Failures of a single description leave the pace alone
+    CHECK(0. > governor.failed("invalid submit description", 0));
+    CHECK(8. == governor.get_rate());
+
+    // Multiplicative decrease on transient failures, down to min_rate
+    CHECK(0. > governor.failed("schedd busy", 3));
+    CHECK(4. == governor.get_rate());
+    CHECK(0. > governor.failed("schedd busy", 3));
+    CHECK(0. > governor.failed("schedd busy", 3));
+    CHECK(0. > governor.failed("schedd busy", 3));
+    CHECK(1. == governor.get_rate());
+
+    // Additive increase, up to max_rate
+    governor.succeeded(.5);
+    CHECK(.5 == governor.get_latency());
+    CHECK(2. == governor.get_rate());
+    for (int i = 0; i < 10; ++i)
+        governor.succeeded(.5);
+    CHECK(8. == governor.get_rate());
+
+    // Slow submissions
+    governor.succeeded(5.);
+    CHECK(1. < governor.get_latency());
+    CHECK(4. == governor.get_rate());
+
+    // Exponential backoff with jitter, bounded
+    for (int i = 0; i < 100; ++i)
+    {
+        double delay = governor.failed("schedd busy", 0);
+        CHECK(1. <= delay && delay < 3.);
+
+        delay = governor.failed("schedd busy", 2);
+        CHECK(2.5 <= delay && delay < 7.5);
+    }
+
+    CHECK(0. > governor.failed("schedd busy", 3));
+
+    // Disabled: no retries
+    config.enabled = false;
+    submit_governor disabled(config);
+    CHECK(0. > disabled.failed("schedd busy", 0));
+    disabled.wait_turn();
+
+    return report_checks();
+}
@@ -0,0 +1,117 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "../task_bundler.hpp"
+
+#include "test_helpers.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <unistd.h>
+
+using saga::adaptors::condor::task_bundler;
+using saga::adaptors::condor::test::report_checks;
+
+// A task running script with sh -c.
+task_bundler::task make_task(std::string const & script)
+{
+    task_bundler::task t;
+    t.executable = "/bin/sh";
+    t.arguments.push_back("-c");
+    t.arguments.push_back(script);
+    return t;
+}
+
+//  Runs script with sh, as Condor runs the wrapper, returning its standard
+//  output.
+std::string run(std::string const & script)
+{
+    char path[] = "/tmp/task-bundler-XXXXXX";
+    int const fd = ::mkstemp(path);
+    if (-1 == fd)
+        return std::string();
+    ::close(fd);
+
+    {
+        std::ofstream file(path);
+        file << script;
+    }
+
+    std::string output;
+    if (FILE * p = ::popen(("sh " + std::string(path)).c_str(), "r"))
+    {
+        char buffer[256];
+        while (std::size_t n = std::fread(buffer, 1, sizeof(buffer), p))
+            output.append(buffer, n);
+        ::pclose(p);
+    }
+
+    ::unlink(path);
+    return output;
+}
+
+int main()
+{
+    // Task IDs
+    {
+        CHECK("12:0" == task_bundler::get_task_id("12", 0));
+        CHECK("12:31" == task_bundler::get_task_id("12", 31));
+    }
+
+    // Results
+    {
+        std::istringstream results(
+            "SAGA-TASK 0 0\n"
+            "output from a task\n"
+            "SAGA-TASK 2 -1\n"
+            "SAGA-TASK 7 1\n"
+            "SAGA-TASK x 1\n");
+
+        std::vector<int> exit_codes(3, 0);
+        std::vector<bool> reported(3, false);
+        task_bundler::read_results(results, exit_codes, reported);
+
+        CHECK(reported[0] && 0 == exit_codes[0]);
+        CHECK(!reported[1]);
+        CHECK(reported[2] && -1 == exit_codes[2]);
+    }
+
+    // Wrapper scripts run each task and report its exit code
+    {
+        std::vector<task_bundler::task> tasks;
+        tasks.push_back(make_task("exit 3"));
+        tasks.push_back(make_task("test \"$X\" = \"it's\""));
+        tasks.push_back(make_task("test \"$(pwd)\" = /tmp"));
+        tasks.push_back(make_task("exit 0"));
+
+        tasks[1].environment.push_back("X=it's");
+        tasks[2].working_directory = "/tmp";
+        tasks[3].executable = "/nonexistent";
+
+        for (std::size_t parallel = 1; parallel <= 3; parallel += 2)
+        {
+            std::string const script
+                = task_bundler::make_wrapper(tasks, parallel);
+            CHECK(0 == script.find("#!/bin/sh\n"));
+
+            std::istringstream results(run(script));
+
+            std::vector<int> exit_codes(tasks.size(), -1);
+            std::vector<bool> reported(tasks.size(), false);
+            task_bundler::read_results(results, exit_codes, reported);
+
+            CHECK(reported[0] && 3 == exit_codes[0]);
+            CHECK(reported[1] && 0 == exit_codes[1]);
+            CHECK(reported[2] && 0 == exit_codes[2]);
+            CHECK(reported[3] && 0 != exit_codes[3]);
+        }
+    }
+
+    return report_checks();
+}
@@ -0,0 +1,55 @@
+//  Copyright (c) 2008 João Abecasis
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAGA_ADAPTORS_CONDOR_JOB_TEST_TEST_HELPERS_HPP
+#define SAGA_ADAPTORS_CONDOR_JOB_TEST_TEST_HELPERS_HPP
+
+#include "../clock.hpp"
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+namespace saga { namespace adaptors { namespace condor { namespace test {
+
+    // Number of CHECKs that failed so far.
+    inline int & failed_checks()
+    {
+        static int failed = 0;
+        return failed;
+    }
+
+    //  Prints the outcome of the test. Returns the number of failed CHECKs,
+    //  for main to return.
+    inline int report_checks()
+    {
+        int const failed = failed_checks();
+        std::cout << (failed ? "**** Test FAILED!\n" : "---- Test passed!\n")
+            << std::flush;
+        return failed;
+    }
+
+    // Wall-clock time, in seconds.
+    using detail::now;
+
+    // Percentile p, in [0, 1], of sorted samples. 0 if there are none.
+    inline double percentile(std::vector<double> const & sorted, double p)
+    {
+        if (sorted.empty())
+            return 0.;
+        return sorted[std::size_t(p * (sorted.size() - 1) + 0.5)];
+    }
+
+}}}} // namespace saga::adaptors::condor::test
+
+#define CHECK(expr)                                                         \
+    if (!(expr))                                                            \
+    {                                                                       \
+        ++saga::adaptors::condor::test::failed_checks();                    \
+        std::cout << "**** Check FAILED: " #expr "\n" << std::flush;        \
+    }                                                                       \
+    /**/
+
+#endif // include guard